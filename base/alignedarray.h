@@ -0,0 +1,74 @@
+#ifndef BASE_ALIGNEDARRAY_H_
+#define BASE_ALIGNEDARRAY_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include <boost/noncopyable.hpp>
+#include "base/cacheline.h"
+
+namespace base {
+
+/**
+ * Fixed size array of T(firstId), T(firstId + 1) ... T(firstId + n - 1) in one cache line aligned allocation.
+ * Used by the queues to keep their blocks next to each other instead of scattered on the heap.
+ */
+template <typename T>
+class AlignedArray : private boost::noncopyable
+{
+public:
+
+    AlignedArray() : items_(NULL), size_(0)
+    {
+    }
+
+    ~AlignedArray()
+    {
+        clear();
+    }
+
+    void allocate(uint32_t n, uint32_t firstId = 0)
+    {
+        clear();
+        void *memory = NULL;
+        if (posix_memalign(&memory, kCacheLineSize, n * sizeof(T)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+        items_ = static_cast<T *>(memory);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            new (items_ + i) T(firstId + i);
+            size_ = i + 1;  // so clear() only destroys what was constructed
+        }
+    }
+
+    void clear()
+    {
+        for (uint32_t i = 0; i < size_; i++)
+        {
+            items_[i].~T();
+        }
+        free(items_);
+        items_ = NULL;
+        size_ = 0;
+    }
+
+    T *get(uint32_t i)
+    {
+        return items_ + i;
+    }
+
+    uint32_t size() const
+    {
+        return size_;
+    }
+
+private:
+    T *items_;
+    uint32_t size_;
+};
+
+}  // namespace base
+
+#endif  // BASE_ALIGNEDARRAY_H_
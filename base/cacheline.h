@@ -0,0 +1,17 @@
+#ifndef BASE_CACHELINE_H_
+#define BASE_CACHELINE_H_
+
+#include <stddef.h>
+
+namespace base {
+
+// size of a cache line on the machines we run on (x86-64)
+static const size_t kCacheLineSize = 64;
+
+}  // namespace base
+
+// put a member (or a type) on its own cache line so that data written by
+// one thread does not share a line with data written by another thread
+#define BASE_CACHELINE_ALIGNED __attribute__((aligned(64)))
+
+#endif  // BASE_CACHELINE_H_
@@ -0,0 +1,23 @@
+#ifndef BASE_CPU_H_
+#define BASE_CPU_H_
+
+namespace base {
+
+//
+// tell the cpu we are in a spin-wait loop. On x86 this is the pause instruction,
+// which saves power and lets the other hyperthread run while we spin
+//
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    asm volatile("" ::: "memory");
+#endif
+}
+
+}  // namespace base
+
+#endif  // BASE_CPU_H_
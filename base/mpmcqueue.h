@@ -0,0 +1,226 @@
+#ifndef BASE_MPMCQUEUE_H_
+#define BASE_MPMCQUEUE_H_
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include "base/alignedarray.h"
+#include "base/cacheline.h"
+
+namespace base {
+
+/**
+ * base::MpmcQueue is a lock-free bounded queue for any number of producer and consumer
+ * threads, e.g. several transport threads feeding one master.
+ * It keeps the slot API of base::ProducerConsumerQueue (tryGetWriteSlot()/slotWritten() and
+ * tryGetReadSlot()/slotRead()) and holds the same base::Block<T> objects.
+ *
+ * Every block has a cell with a sequence number. Positions grow forever and position p
+ * maps to cell p & mask_. For cell i:
+ * - sequence == p           the cell is free for the producer that claims position p
+ * - sequence == p + 1       the cell holds the data written for position p
+ * - sequence == p + size_   the data was read, the cell is free for position p + size_
+ * Producers claim a position with a CAS on tail_ once they see its cell free, consumers
+ * do the same on head_. The sequence store in slotWritten()/slotRead() is what hands the
+ * cell over to the other side, so a slot can be filled or read outside the CAS loop.
+ *
+ * The number of blocks is rounded up to a power of two. Threads can hold several slots
+ * at once but a cell is only handed out again once it's released, so a slow producer
+ * (or consumer) stalls the others when the ring wraps around to its cell.
+ */
+template <typename T>
+class MpmcQueue
+{
+public:
+
+    MpmcQueue() : configured_(false), size_(0), mask_(0), head_(0), tail_(0)
+    {
+    }
+
+    ~MpmcQueue()
+    {
+        clean();
+    }
+
+    void clean()
+    {
+        if (configured_)
+        {
+            configured_ = false;
+            blocks_.clear();
+            storage_.clear();
+            cells_.clear();
+        }
+    }
+
+    //
+    // must be called before the producer and consumer threads start
+    //
+    void configure(uint32_t numBuffers)
+    {
+        clean();  // clean if previously configured
+
+        size_ = 1;
+        while (size_ < numBuffers)
+        {
+            size_ <<= 1;
+        }
+        mask_ = size_ - 1;
+
+        blocks_.reserve(size_);
+        storage_.allocate(size_);
+        cells_.allocate(size_);
+        for (uint32_t i = 0; i < size_; i++)
+        {
+            blocks_.push_back(storage_.get(i));
+            cells_.get(i)->sequence.store(i, boost::memory_order_relaxed);
+        }
+
+        head_.store(0, boost::memory_order_relaxed);
+        tail_.store(0, boost::memory_order_relaxed);
+        configured_ = true;
+    }
+
+    uint32_t capacity() const
+    {
+        return size_;
+    }
+
+    //
+    // reserve a block (producer side)
+    // returns true on success and false if the queue is full. Never blocks.
+    //
+    bool tryGetWriteSlot(T **block)
+    {
+        uint32_t position = tail_.load(boost::memory_order_relaxed);
+        while (true)
+        {
+            Cell *cell = cells_.get(position & mask_);
+            const int32_t diff = static_cast<int32_t>(
+                cell->sequence.load(boost::memory_order_acquire) - position);
+            if (diff == 0)
+            {
+                if (tail_.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed))
+                {
+                    cell->position = position;
+                    *block = blocks_[position & mask_];
+                    return true;
+                }
+                // position was reloaded by the failed CAS
+            }
+            else if (diff < 0)
+            {
+                return false;  // full: the cell still holds data from the previous lap
+            }
+            else
+            {
+                position = tail_.load(boost::memory_order_relaxed);  // another producer got it
+            }
+        }
+    }
+
+    //
+    // reserve a block, spinning until one is free
+    //
+    void getWriteSlot(T **block)
+    {
+        while (!tryGetWriteSlot(block))
+        {
+            boost::this_thread::yield();
+        }
+    }
+
+    //
+    // publish a block returned by tryGetWriteSlot()
+    //
+    void slotWritten(T *block)
+    {
+        Cell *cell = cells_.get(block->id);
+        cell->sequence.store(cell->position + 1, boost::memory_order_release);
+    }
+
+    //
+    // get a block with valid data (consumer side)
+    // returns true on success and false if the queue is empty. Never blocks.
+    //
+    bool tryGetReadSlot(T **block)
+    {
+        uint32_t position = head_.load(boost::memory_order_relaxed);
+        while (true)
+        {
+            Cell *cell = cells_.get(position & mask_);
+            const int32_t diff = static_cast<int32_t>(
+                cell->sequence.load(boost::memory_order_acquire) - (position + 1));
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed))
+                {
+                    cell->position = position;
+                    *block = blocks_[position & mask_];
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // empty: nothing written for this position yet
+            }
+            else
+            {
+                position = head_.load(boost::memory_order_relaxed);  // another consumer got it
+            }
+        }
+    }
+
+    //
+    // get a block with valid data, spinning until one is available
+    //
+    void getReadSlot(T **block)
+    {
+        while (!tryGetReadSlot(block))
+        {
+            boost::this_thread::yield();
+        }
+    }
+
+    //
+    // mark a block returned by tryGetReadSlot() as read so a producer can reuse it
+    //
+    void slotRead(T *block)
+    {
+        Cell *cell = cells_.get(block->id);
+        cell->sequence.store(cell->position + size_, boost::memory_order_release);
+    }
+
+private:
+
+    struct BASE_CACHELINE_ALIGNED Cell
+    {
+        explicit Cell(uint32_t id) : sequence(id), position(0)
+        {
+        }
+
+        boost::atomic<uint32_t> sequence;
+        // position the cell was last claimed for, only touched by the thread holding it
+        uint32_t position;
+    };
+
+    bool configured_;
+    // all the blocks and their cells, in cache line aligned allocations
+    AlignedArray<T> storage_;
+    AlignedArray<Cell> cells_;
+    std::vector<T *> blocks_;
+    uint32_t size_;
+    uint32_t mask_;
+
+    // claimed by consumers
+    BASE_CACHELINE_ALIGNED boost::atomic<uint32_t> head_;
+
+    // claimed by producers
+    BASE_CACHELINE_ALIGNED boost::atomic<uint32_t> tail_;
+};
+
+}  // namespace base
+
+#endif  // BASE_MPMCQUEUE_H_
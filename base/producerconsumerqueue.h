@@ -3,30 +3,50 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <boost/atomic.hpp>
 #include <boost/thread.hpp>
+#include "base/alignedarray.h"
+#include "base/cacheline.h"
+#include "base/cpu.h"
+#include "base/queuestats.h"
 
 namespace base {
 
 /**
  * A block is a class to exchange information between pipeline stages.
  * T is the type of data to be enchanged. Can be an integer or a complex object.
+ *
+ * Blocks are cache line aligned and the queues keep them in one contiguous array.
+ * The bookkeeping done on the producer side (getting and writing a slot) and on the
+ * consumer side (reading and releasing a slot) are on separate cache lines, so the
+ * queue bookkeeping of the producer and the consumer threads never write the same line.
  */
 template <typename T>
-struct Block
+struct BASE_CACHELINE_ALIGNED Block
 {
     uint64_t id;
     T data;
 
     bool shutdownStage;
-    int64_t index;
-    bool locked;
-    bool hasValidData;
 
-    explicit Block() : locked(false), hasValidData(false), shutdownStage(false)
+    // producer side, written by the queue when the block is handed to a producer and written
+    BASE_CACHELINE_ALIGNED int64_t index;
+    uint64_t timesLocked;
+    uint64_t timesWritten;
+
+    // consumer side, written by the queue when the block is handed to a consumer and read
+    BASE_CACHELINE_ALIGNED uint64_t timesTaken;
+    uint64_t timesReleased;
+
+    explicit Block() : id(0), shutdownStage(false), index(-1), timesLocked(0), timesWritten(0), timesTaken(0), timesReleased(0)
     {
     }
 
-    Block(uint64_t id0) :id(id0), locked(false), hasValidData(false), shutdownStage(false)
+    Block(uint64_t id0) : id(id0), shutdownStage(false), index(-1), timesLocked(0), timesWritten(0), timesTaken(0), timesReleased(0)
     {
     }
 
@@ -34,6 +54,18 @@ struct Block
     {
     }
 
+    // a producer or a consumer holds the block
+    bool locked() const
+    {
+        return timesLocked != timesReleased;
+    }
+
+    // the block was written and no consumer took it yet
+    bool hasValidData() const
+    {
+        return timesWritten != timesTaken;
+    }
+
     void print()
     {
         printf("\tid:        %d\n", id);
@@ -42,48 +74,137 @@ struct Block
 
 
 
+/**
+ * How a thread waits in the tryGet*Slot(s)() calls when there is no block for it.
+ */
+class WaitPolicy {
+public:
+    enum value {
+        PARK,       // sleep on a condition variable for up to 1ms. Cheapest on cpu, slowest to wake up
+        SPIN,       // busy-spin with pause instructions and never sleep. Burns a core, fastest to wake up
+        ADAPTIVE    // spin for a while, then yield the cpu for a while, then park
+    };
+};
+
 /**
  * base::ProducerConsumerQueue holds blocks between pipeline stages. See block class above.
  * Producers write blocks to the base::ProducerConsumerQueue using the getWriteSlot() and slotWritten() API.
  * Consumers read blocks from the base::ProducerConsumerQueue using the getReadSlot() and slotRead() API.
+ * Free blocks are kept in a free list and written blocks in a ring of ids, so every
+ * operation is O(1) regardless of the number of blocks.
+ * Consumers that wait on other things too (e.g. a socket) can poll readFd() instead of
+ * blocking in getReadSlot(), and producers can poll writeFd() instead of blocking in getWriteSlot().
+ * The tryGet*Slot(s)() calls wait according to the WaitPolicy given to configure().
+ * The capacity can be changed with resize() while producers and consumers are running.
+ * enableStats() turns on counters (see base::QueueStats) that can be read with stats() while the queue is in use.
  */
 template <typename T>
 class ProducerConsumerQueue
 {
 public:
 
-    ProducerConsumerQueue() : configured_(false) {
+    ProducerConsumerQueue() : configured_(false), capacity_(0), waitPolicy_(WaitPolicy::PARK), statsEnabled_(false), readyHead_(0), readyCount_(0),
+        numFree_(0), numValid_(0), readFd_(-1), readFdSignalled_(false), writeFd_(-1), writeFdSignalled_(false) {
     }
 
     ~ProducerConsumerQueue()
     {
         clean();
+        if (readFd_ >= 0)
+        {
+            close(readFd_);
+        }
+        if (writeFd_ >= 0)
+        {
+            close(writeFd_);
+        }
+    }
+
+    //
+    // start (or stop) updating the counters returned by stats()
+    //
+    void enableStats(bool enable)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        statsEnabled_ = enable;
+    }
+
+    //
+    // counters updated while stats are enabled. Safe to read from any thread at any time
+    //
+    const QueueStats& stats() const
+    {
+        return stats_;
+    }
+
+    //
+    // file descriptor that is readable (POLLIN) while there are blocks with valid data.
+    // Only poll it, the queue reads and writes it.
+    // It is created on the first call so queues nobody polls don't pay for it
+    //
+    int readFd()
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (readFd_ < 0)
+        {
+            readFd_ = createEventFd();
+            readFdSignalled_ = false;
+            readyCountChanged();
+        }
+        return readFd_;
+    }
+
+    //
+    // same as readFd() for free blocks: readable (POLLIN) while a write slot can be reserved
+    //
+    int writeFd()
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (writeFd_ < 0)
+        {
+            writeFd_ = createEventFd();
+            writeFdSignalled_ = false;
+            freeCountChanged();
+        }
+        return writeFd_;
     }
 
     void clean()
     {
         if (configured_)
         {
-            for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+            configured_ = false;
+            blocks_.clear();
+            for (typename std::vector<AlignedArray<T> *>::iterator it = segments_.begin(); it != segments_.end(); it++)
             {
                 delete *it;
             }
-            configured_ = false;
-            blocks_.clear();
+            segments_.clear();
+            freeList_.clear();
+            readyRing_.clear();
         }
     }
 
 
-    void configure(uint32_t numBuffers) {
+    void configure(uint32_t numBuffers, WaitPolicy::value waitPolicy = WaitPolicy::PARK) {
         clean();  // clean if previously configured
         size_ = numBuffers;
+        capacity_ = numBuffers;
+        waitPolicy_ = waitPolicy;
 
         blocks_.reserve(numBuffers);
-        for (uint32_t i = 0; i < numBuffers; i++)
+        freeList_.reserve(numBuffers);
+        addSegment(numBuffers);
+        // hand out low ids first
+        for (uint32_t i = numBuffers; i > 0; i--)
         {
-            T *block = new T(i);
-            blocks_.push_back(block);
+            freeList_.push_back(i - 1);
         }
+        freeCountChanged();
+        readyRing_.assign(numBuffers, 0);
+        readyHead_ = 0;
+        readyCount_ = 0;
+        readyCountChanged();
 
         lastBufferGiven_ = -1;
         lastBufferAdded_ = -1;
@@ -92,95 +213,130 @@ public:
     }
 
 
-    void getNextFreePosition(T **block, bool &hasFreePositions)
+    //
+    // change the number of blocks that can be in use at the same time.
+    // Safe to call while producers and consumers are running: no block in use is dropped.
+    // Growing reuses blocks left over from an earlier shrink before allocating new ones.
+    // Shrinking takes the blocks with the highest ids out of the free list, and blocks in
+    // use over the new capacity are not handed out again once they are read.
+    // Their memory is kept until clean() in case the queue grows again.
+    //
+    void resize(uint32_t capacity)
     {
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (capacity == capacity_)
         {
-            if (!((*it)->locked))
+            return;
+        }
+        uint32_t allocated = blocks_.size();
+        if (capacity > capacity_)
+        {
+            // idle blocks left over from a shrink. Those still in use are freed by markRead()
+            uint32_t end = std::min(capacity, allocated);
+            for (uint32_t id = capacity_; id < end; id++)
             {
-                (*it)->locked = true;
-                if ((*it)->hasValidData)
+                if (!blocks_[id]->locked())
                 {
-                    assert(0);
-                    printf("%p: Error!!! Locking buffer and hasValidData is 1\n", this);
+                    freeList_.push_back(id);
                 }
-                *block = *it;
-                hasFreePositions = true;
-                return;
-            }
-            else
-            {
             }
         }
-        hasFreePositions = false;
-        return;
-    }
-    bool getNextFreePosition(T **block)
-    {
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+        else
         {
-            if (!((*it)->locked))
+            uint32_t kept = 0;
+            for (uint32_t i = 0; i < freeList_.size(); i++)
             {
-                (*it)->locked = true;
-                if ((*it)->hasValidData)
+                if (freeList_[i] < capacity)
                 {
-                    assert(0);
-                    printf("%p: Error!!! Locking buffer and hasValidData is 1\n", this);
+                    freeList_[kept++] = freeList_[i];
                 }
-                *block = *it;
-                return true;
             }
-            else
+            freeList_.resize(kept);
+        }
+        if (capacity > allocated)
+        {
+            addSegment(capacity - allocated);
+            // new blocks go straight to the free list
+            for (uint32_t id = capacity; id > allocated; id--)
+            {
+                freeList_.push_back(id - 1);
+            }
+            // the ring has to be able to hold every block. Unwrap it into a bigger one
+            std::vector<uint32_t> ring(blocks_.size(), 0);
+            for (uint32_t i = 0; i < readyCount_; i++)
             {
+                ring[i] = readyRing_[(readyHead_ + i) % size_];
             }
+            readyRing_.swap(ring);
+            readyHead_ = 0;
+            size_ = blocks_.size();
+        }
+        capacity_ = capacity;
+        freeCountChanged();
+        if (!freeList_.empty())
+        {
+            bufferHasFreeSlots_.notify_all();
         }
-        return false;
     }
 
-    void getNextValidPosition(T **block, bool &hasValidData)
+    uint32_t capacity()
     {
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
-        {
-            if ((*it)->hasValidData && ((*it)->index == ((uint64_t)(lastBufferGiven_ + 1))))
-            {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        return capacity_;
+    }
 
-                lastBufferGiven_++;
-                if (!(*it)->locked)
-                {
-                    assert(0);
-                    printf("%p: Error getting valid data and buffer is not locked!!! \n", this);
-                }
-                (*it)->hasValidData = false;
-                *block = *it;
-                hasValidData = true;
-                return;
-            }
+    void getNextFreePosition(T **block, bool &hasFreePositions)
+    {
+        hasFreePositions = getNextFreePosition(block);
+    }
+    bool getNextFreePosition(T **block)
+    {
+        if (freeList_.empty())
+        {
+            return false;
         }
-        hasValidData = false;
-        return;
+        T *free = blocks_[freeList_.back()];
+        freeList_.pop_back();
+        freeCountChanged();
+        if (free->locked() || free->hasValidData())
+        {
+            assert(0);
+            printf("%p: Error!!! Locking buffer that is locked or hasValidData\n", this);
+        }
+        ++free->timesLocked;
+        *block = free;
+        return true;
+    }
+
+    void getNextValidPosition(T **block, bool &hasValidData)
+    {
+        hasValidData = getNextValidPosition(block);
     }
 
+    //
+    // get a specific block. This one is O(number of blocks with valid data)
+    //
     void getNextValidPosition(T **block, uint64_t id, bool &hasValidData)
     {
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+        for (uint32_t i = 0; i < readyCount_; i++)
         {
-            if ((*it)->hasValidData)
+            uint32_t position = (readyHead_ + i) % size_;
+            if (readyRing_[position] != id)
             {
-                if((*it)->id != id) {
-                    printf("id mismatch: looking for: %ld, found: %ld\n", id, (*it)->id);
-                    continue;
-                }
-                lastBufferGiven_++;
-                if (!(*it)->locked)
-                {
-                    assert(0);
-                    printf("%p: Error getting valid data and buffer is not locked!!! \n", this);
-                }
-                (*it)->hasValidData = false;
-                *block = *it;
-                hasValidData = true;
-                return;
+                continue;
             }
+            // close the gap so the remaining blocks keep their order
+            for (uint32_t j = i; j > 0; j--)
+            {
+                readyRing_[(readyHead_ + j) % size_] = readyRing_[(readyHead_ + j - 1) % size_];
+            }
+            readyHead_ = (readyHead_ + 1) % size_;
+            --readyCount_;
+            readyCountChanged();
+            lastBufferGiven_++;
+            takeValidBlock(blocks_[id], block);
+            hasValidData = true;
+            return;
         }
         hasValidData = false;
         printf("no valid found\n");
@@ -189,23 +345,17 @@ public:
 
     bool getNextValidPosition(T **block)
     {
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+        if (readyCount_ == 0)
         {
-            if ((*it)->hasValidData && ((*it)->index == ((uint64_t)(lastBufferGiven_ + 1))))
-            {
-
-                lastBufferGiven_++;
-                if (!(*it)->locked)
-                {
-                    assert(0);
-                    printf("%p: Error getting valid data and buffer is not locked!!! \n", this);
-                }
-                (*it)->hasValidData = false;
-                *block = *it;
-                return true;
-            }
+            return false;
         }
-        return false;
+        uint32_t id = readyRing_[readyHead_];
+        readyHead_ = (readyHead_ + 1) % size_;
+        --readyCount_;
+        readyCountChanged();
+        lastBufferGiven_++;
+        takeValidBlock(blocks_[id], block);
+        return true;
     }
 
     //
@@ -218,12 +368,14 @@ public:
 
         bool hasFreePositions = false;
         getNextFreePosition(block, hasFreePositions);
+        uint64_t start = statsEnabled_ ? QueueStats::nowMicros() : 0;
         while (!hasFreePositions)
         {
             //printf("%p: Waiting for free slots...\n", this);
             bufferHasFreeSlots_.wait(lock);
             getNextFreePosition(block, hasFreePositions);
         }
+        countWait(stats_.producerWaitMicros, start);
     }
 
     //
@@ -235,20 +387,20 @@ public:
         boost::unique_lock<boost::mutex> lock(mutex_);
         //mutex_.lock();
 
+        count(stats_.writeAttempts);
         bool hasFreePositions = false;
         getNextFreePosition(block, hasFreePositions);
         while (!hasFreePositions)
         {
             //printf("%p: Waiting for free slots...\n", this);
-            boost::system_time const timeout = boost::get_system_time() + boost::posix_time::milliseconds(1);
-            if (bufferHasFreeSlots_.timed_wait(lock, timeout, boost::bind(&base::ProducerConsumerQueue<T>::getNextFreePosition, this, block))) {
-                return true;
+            if (waitForFreePositions(lock)) {
+                return getNextFreePosition(block);
             }
             else {
                 //std::cout << "timeout while write" << std::endl;
+                count(stats_.writeFailures);
                 return false;
             }
-            
         }
         return true;//success
     }
@@ -261,31 +413,50 @@ public:
     void slotWritten(T *block)
     {
         mutex_.lock();
-
-        bool found = false;
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+        if (markWritten(block))
         {
-            if ((*it)->id == block->id)
-            {
-                found = true;
-                (*it)->hasValidData = true;
-                lastBufferAdded_++;
-                (*it)->index = lastBufferAdded_;
-
-                if (!(*it)->locked)
-                {
-                    assert(0);
-                    printf("%p: Error!!! setting hasValidData and locked is false\n", this);
-                }
+            bufferHasValidData_.notify_all();
+        }
+        mutex_.unlock();
+    }
 
-                bufferHasValidData_.notify_all();
-            }
+    //
+    // reserve up to n blocks at once.
+    // blocks is filled with the reserved blocks, returns how many were reserved (0 on failure)
+    //
+    uint32_t tryGetWriteSlots(std::vector<T *> &blocks, uint32_t n)
+    {
+        blocks.clear();
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        count(stats_.writeAttempts);
+        if (!hasFreePositions() && !waitForFreePositions(lock))
+        {
+            count(stats_.writeFailures);
+            return 0;
         }
-        if (!found)
+        T *block;
+        while (blocks.size() < n && getNextFreePosition(&block))
         {
-            printf("%p: slotWritten -> buffer %ld not found\n", this, block->id);
+            blocks.push_back(block);
         }
+        return blocks.size();
+    }
 
+    //
+    // mark a batch of blocks as having valid data. Consumers see them in the order of blocks.
+    //
+    void slotsWritten(const std::vector<T *> &blocks)
+    {
+        mutex_.lock();
+        bool written = false;
+        for (typename std::vector<T *>::const_iterator it = blocks.begin(); it != blocks.end(); it++)
+        {
+            written |= markWritten(*it);
+        }
+        if (written)
+        {
+            bufferHasValidData_.notify_all();
+        }
         mutex_.unlock();
     }
 
@@ -297,12 +468,14 @@ public:
         boost::unique_lock<boost::mutex> lock(mutex_);
         bool hasValidData = false;
         getNextValidPosition(block, hasValidData);
+        uint64_t start = statsEnabled_ ? QueueStats::nowMicros() : 0;
         while (!hasValidData)
         {
             //printf("%p: Waiting for slots with valid data...\n", this);
             bufferHasValidData_.wait(lock);
             getNextValidPosition(block, hasValidData);
         }
+        countWait(stats_.consumerWaitMicros, start);
     }
 
     //
@@ -313,27 +486,30 @@ public:
         boost::unique_lock<boost::mutex> lock(mutex_);
         bool hasValidData = false;
         getNextValidPosition(block, id, hasValidData);
+        uint64_t start = statsEnabled_ ? QueueStats::nowMicros() : 0;
         while (!hasValidData)
         {
             //printf("%p: Waiting for slots with valid data...\n", this);
             bufferHasValidData_.wait(lock);
             getNextValidPosition(block, id, hasValidData);
         }
+        countWait(stats_.consumerWaitMicros, start);
     }
 
     
     bool tryGetReadSlot(T **block)
     {
         boost::unique_lock<boost::mutex> lock(mutex_);
+        count(stats_.readAttempts);
         bool hasValidData = false;
         getNextValidPosition(block, hasValidData);
         while (!hasValidData)
         {
-            boost::system_time const timeout = boost::get_system_time() + boost::posix_time::milliseconds(1);
-            if (bufferHasValidData_.timed_wait(lock, timeout, boost::bind(&base::ProducerConsumerQueue<T>::getNextValidPosition, this, block))){
-                return true;
+            if (waitForValidData(lock)){
+                return getNextValidPosition(block);
             }
             else {
+                count(stats_.readFailures);
                 return false;
             }
         }
@@ -347,39 +523,305 @@ public:
     void slotRead(T *block)
     {
         mutex_.lock();
-        bool found = false;
-        for (typename std::vector<T *>::iterator it = blocks_.begin(); it != blocks_.end(); it++)
+        if (markRead(block))
         {
-            if ((*it)->id == block->id)
-            {
-                found = true;
-                if (!(*it)->locked)
-                {
-                    assert(0);
-                    printf("%p: Error!!! locked was 0 in slotRead\n", this);
-                }
-                (*it)->locked = false;
-                if ((*it)->hasValidData)
-                {
-                    assert(0);
-                    printf("%p: Error!!! Freeing buffer and hasValidData is 1\n", this);
-                }
-                bufferHasFreeSlots_.notify_all();
-            }
+            bufferHasFreeSlots_.notify_all();
         }
-        if (!found)
+        mutex_.unlock();
+    }
+
+    //
+    // get up to max blocks with valid data at once, oldest first.
+    // blocks is filled with the blocks, returns how many there are (0 on failure)
+    //
+    uint32_t tryGetReadSlots(std::vector<T *> &blocks, uint32_t max)
+    {
+        blocks.clear();
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        count(stats_.readAttempts);
+        if (!hasValidData() && !waitForValidData(lock))
         {
-            printf("%p: slotRead -> buffer %ld not found\n", this, block->id);
+            count(stats_.readFailures);
+            return 0;
+        }
+        T *block;
+        while (blocks.size() < max && getNextValidPosition(&block))
+        {
+            blocks.push_back(block);
+        }
+        return blocks.size();
+    }
+
+    //
+    // mark a batch of blocks as read so base::ProducerConsumerQueue can reuse them
+    //
+    void slotsRead(const std::vector<T *> &blocks)
+    {
+        mutex_.lock();
+        bool read = false;
+        for (typename std::vector<T *>::const_iterator it = blocks.begin(); it != blocks.end(); it++)
+        {
+            read |= markRead(*it);
+        }
+        if (read)
+        {
+            bufferHasFreeSlots_.notify_all();
         }
         mutex_.unlock();
     }
 private:
 
+    bool hasFreePositions() const
+    {
+        return !freeList_.empty();
+    }
+
+    bool hasValidData() const
+    {
+        return readyCount_ > 0;
+    }
+
+    // called with lock held when there are no free blocks.
+    // waits according to waitPolicy_ and returns true if there are free blocks now
+    bool waitForFreePositions(boost::unique_lock<boost::mutex> &lock)
+    {
+        uint64_t start = statsEnabled_ ? QueueStats::nowMicros() : 0;
+        bool hasFree;
+        if (spinUntilNonZero(numFree_, lock) || waitPolicy_ == WaitPolicy::SPIN)
+        {
+            hasFree = hasFreePositions();
+        }
+        else
+        {
+            boost::system_time const timeout = boost::get_system_time() + boost::posix_time::milliseconds(1);
+            // the predicate can be evaluated more than once so it must not take the block itself
+            hasFree = bufferHasFreeSlots_.timed_wait(lock, timeout, boost::bind(&base::ProducerConsumerQueue<T>::hasFreePositions, this));
+        }
+        countWait(stats_.producerWaitMicros, start);
+        return hasFree;
+    }
+
+    // same as waitForFreePositions() for blocks with valid data
+    bool waitForValidData(boost::unique_lock<boost::mutex> &lock)
+    {
+        uint64_t start = statsEnabled_ ? QueueStats::nowMicros() : 0;
+        bool hasValid;
+        if (spinUntilNonZero(numValid_, lock) || waitPolicy_ == WaitPolicy::SPIN)
+        {
+            hasValid = hasValidData();
+        }
+        else
+        {
+            boost::system_time const timeout = boost::get_system_time() + boost::posix_time::milliseconds(1);
+            hasValid = bufferHasValidData_.timed_wait(lock, timeout, boost::bind(&base::ProducerConsumerQueue<T>::hasValidData, this));
+        }
+        countWait(stats_.consumerWaitMicros, start);
+        return hasValid;
+    }
+
+    // must be called with mutex_ held
+    void count(boost::atomic<uint64_t> &counter)
+    {
+        if (statsEnabled_)
+        {
+            QueueStats::add(counter, 1);
+        }
+    }
+
+    // must be called with mutex_ held. start is what nowMicros() returned when the wait started,
+    // 0 if stats were off then: a wait that started before enableStats(true) isn't counted
+    void countWait(boost::atomic<uint64_t> &counter, uint64_t start)
+    {
+        if (statsEnabled_ && (start != 0))
+        {
+            QueueStats::add(counter, QueueStats::nowMicros() - start);
+        }
+    }
+
+    // spin (and yield for ADAPTIVE) with lock released until count is not zero.
+    // returns true if it saw count become non zero. Never spins for PARK
+    bool spinUntilNonZero(const boost::atomic<uint32_t> &count, boost::unique_lock<boost::mutex> &lock)
+    {
+        if (waitPolicy_ == WaitPolicy::PARK)
+        {
+            return false;
+        }
+        bool nonZero = false;
+        lock.unlock();
+        for (uint32_t i = 0; i < kSpinIterations_ && !nonZero; i++)
+        {
+            cpuRelax();
+            nonZero = count.load(boost::memory_order_relaxed) > 0;
+        }
+        for (uint32_t i = 0; waitPolicy_ == WaitPolicy::ADAPTIVE && i < kYieldIterations_ && !nonZero; i++)
+        {
+            boost::this_thread::yield();
+            nonZero = count.load(boost::memory_order_relaxed) > 0;
+        }
+        lock.lock();
+        return nonZero;
+    }
+
+    // allocate n more blocks with the next ids. Doesn't touch the free list
+    void addSegment(uint32_t n)
+    {
+        AlignedArray<T> *segment = new AlignedArray<T>();
+        segment->allocate(n, blocks_.size());
+        segments_.push_back(segment);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            blocks_.push_back(segment->get(i));
+        }
+    }
+
+    // must be called with mutex_ held. returns false if the block is not ours
+    bool markWritten(T *block)
+    {
+        if (block->id >= blocks_.size() || blocks_[block->id] != block)
+        {
+            printf("%p: slotWritten -> buffer %ld not found\n", this, block->id);
+            return false;
+        }
+        if (!block->locked())
+        {
+            assert(0);
+            printf("%p: Error!!! setting hasValidData and locked is false\n", this);
+        }
+        ++block->timesWritten;
+        lastBufferAdded_++;
+        block->index = lastBufferAdded_;
+
+        if (statsEnabled_)
+        {
+            stats_.addOccupancy(readyCount_);
+            QueueStats::add(stats_.enqueued, 1);
+        }
+        readyRing_[(readyHead_ + readyCount_) % size_] = block->id;
+        ++readyCount_;
+        readyCountChanged();
+        return true;
+    }
+
+    // must be called with mutex_ held. returns false if the block is not ours
+    bool markRead(T *block)
+    {
+        if (block->id >= blocks_.size() || blocks_[block->id] != block)
+        {
+            printf("%p: slotRead -> buffer %ld not found\n", this, block->id);
+            return false;
+        }
+        if (!block->locked())
+        {
+            assert(0);
+            printf("%p: Error!!! locked was 0 in slotRead\n", this);
+        }
+        if (block->hasValidData())
+        {
+            assert(0);
+            printf("%p: Error!!! Freeing buffer and hasValidData is 1\n", this);
+        }
+        ++block->timesReleased;
+        if (block->id < capacity_)
+        {
+            freeList_.push_back(block->id);
+            freeCountChanged();
+        }
+        // else the queue shrank while the block was in use, keep it idle
+        return true;
+    }
+
+    int createEventFd()
+    {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0)
+        {
+            printf("%p: Error!!! could not create eventfd\n", this);
+        }
+        return fd;
+    }
+
+    // must be called with mutex_ held.
+    // keeps readFd_ readable exactly while there is valid data
+    void readyCountChanged()
+    {
+        numValid_.store(readyCount_, boost::memory_order_relaxed);
+        signalEventFd(readFd_, readFdSignalled_, readyCount_ > 0);
+    }
+
+    // must be called with mutex_ held.
+    // keeps writeFd_ readable exactly while there are free blocks
+    void freeCountChanged()
+    {
+        numFree_.store(freeList_.size(), boost::memory_order_relaxed);
+        signalEventFd(writeFd_, writeFdSignalled_, !freeList_.empty());
+    }
+
+    // makes fd readable or not. Only the transitions cost a system call
+    void signalEventFd(int fd, bool &signalled, bool ready)
+    {
+        if (fd < 0 || signalled == ready)
+        {
+            return;
+        }
+        eventfd_t value = 1;
+        if (ready)
+        {
+            eventfd_write(fd, value);
+        }
+        else
+        {
+            eventfd_read(fd, &value);
+        }
+        signalled = ready;
+    }
+
+    void takeValidBlock(T *valid, T **block)
+    {
+        if (!valid->locked())
+        {
+            assert(0);
+            printf("%p: Error getting valid data and buffer is not locked!!! \n", this);
+        }
+        ++valid->timesTaken;
+        count(stats_.dequeued);
+        *block = valid;
+    }
+
+    // how long SPIN and ADAPTIVE spin (pause instructions) and how long ADAPTIVE yields before parking
+    static const uint32_t kSpinIterations_ = 4000;
+    static const uint32_t kYieldIterations_ = 50;
+
     bool configured_;
+    // max number of blocks in use. There can be more blocks (up to blocks_.size()) after a shrink
+    uint32_t capacity_;
+    WaitPolicy::value waitPolicy_;
+    bool statsEnabled_;
+    QueueStats stats_;
+    // all the blocks, in cache line aligned arrays.
+    // One from configure() and one more for every resize() that needs more blocks
+    std::vector<AlignedArray<T> *> segments_;
+    // blocks_[i]->id == i, so a block is found from its id without searching
     std::vector<T *> blocks_;
+    // ids of the blocks nobody holds. Used as a stack.
+    std::vector<uint32_t> freeList_;
+    // ids of the blocks with valid data in the order they were written.
+    // readyCount_ entries starting at readyHead_ (wrapping around)
+    std::vector<uint32_t> readyRing_;
+    uint32_t readyHead_;
+    uint32_t readyCount_;
+    // copies of freeList_.size() and readyCount_ that spinning threads read without the lock
+    BASE_CACHELINE_ALIGNED boost::atomic<uint32_t> numFree_;
+    BASE_CACHELINE_ALIGNED boost::atomic<uint32_t> numValid_;
+    // eventfd signalled while readyCount_ > 0. -1 until readFd() is called
+    int readFd_;
+    bool readFdSignalled_;
+    // eventfd signalled while freeList_ is not empty. -1 until writeFd() is called
+    int writeFd_;
+    bool writeFdSignalled_;
     boost::condition_variable bufferHasValidData_;
     boost::condition_variable bufferHasFreeSlots_;
     boost::mutex mutex_;
+    // size of readyRing_. Same as blocks_.size()
     uint64_t size_;
     int64_t lastBufferGiven_;
     int64_t lastBufferAdded_;
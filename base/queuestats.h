@@ -0,0 +1,100 @@
+#ifndef BASE_QUEUESTATS_H_
+#define BASE_QUEUESTATS_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <sstream>
+#include <string>
+#include <boost/atomic.hpp>
+
+namespace base {
+
+/**
+ * Counters kept by base::ProducerConsumerQueue when stats are enabled.
+ * They are only written with the queue mutex held, so updates are plain relaxed
+ * loads and stores (no locked instructions), and can be read from any thread at any time.
+ */
+struct QueueStats
+{
+    // occupancy[0] counts writes that found the queue empty,
+    // occupancy[i] writes that found [2^(i-1), 2^i) blocks waiting. The last bucket takes the rest
+    static const int kOccupancyBuckets = 18;
+
+    boost::atomic<uint64_t> enqueued;
+    boost::atomic<uint64_t> dequeued;
+
+    // tryGet*Slot(s)() calls and how many of them came back empty handed
+    boost::atomic<uint64_t> writeAttempts;
+    boost::atomic<uint64_t> writeFailures;
+    boost::atomic<uint64_t> readAttempts;
+    boost::atomic<uint64_t> readFailures;
+
+    // time spent waiting for a free block (producers) and for valid data (consumers)
+    boost::atomic<uint64_t> producerWaitMicros;
+    boost::atomic<uint64_t> consumerWaitMicros;
+
+    boost::atomic<uint64_t> occupancy[kOccupancyBuckets];
+
+    QueueStats()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        enqueued.store(0, boost::memory_order_relaxed);
+        dequeued.store(0, boost::memory_order_relaxed);
+        writeAttempts.store(0, boost::memory_order_relaxed);
+        writeFailures.store(0, boost::memory_order_relaxed);
+        readAttempts.store(0, boost::memory_order_relaxed);
+        readFailures.store(0, boost::memory_order_relaxed);
+        producerWaitMicros.store(0, boost::memory_order_relaxed);
+        consumerWaitMicros.store(0, boost::memory_order_relaxed);
+        for (int i = 0; i < kOccupancyBuckets; i++)
+        {
+            occupancy[i].store(0, boost::memory_order_relaxed);
+        }
+    }
+
+    // only call with the queue mutex held: there is a single writer at a time
+    static void add(boost::atomic<uint64_t> &counter, uint64_t n)
+    {
+        counter.store(counter.load(boost::memory_order_relaxed) + n, boost::memory_order_relaxed);
+    }
+
+    void addOccupancy(uint32_t waiting)
+    {
+        int bucket = (waiting == 0) ? 0 : 32 - __builtin_clz(waiting);
+        add(occupancy[bucket < kOccupancyBuckets ? bucket : kOccupancyBuckets - 1], 1);
+    }
+
+    static uint64_t nowMicros()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+    }
+
+    std::string toString() const
+    {
+        std::ostringstream out;
+        out << "enqueued: " << enqueued.load(boost::memory_order_relaxed) <<
+               " dequeued: " << dequeued.load(boost::memory_order_relaxed) <<
+               " writeFailures: " << writeFailures.load(boost::memory_order_relaxed) <<
+               "/" << writeAttempts.load(boost::memory_order_relaxed) <<
+               " readFailures: " << readFailures.load(boost::memory_order_relaxed) <<
+               "/" << readAttempts.load(boost::memory_order_relaxed) <<
+               " producerWaitMicros: " << producerWaitMicros.load(boost::memory_order_relaxed) <<
+               " consumerWaitMicros: " << consumerWaitMicros.load(boost::memory_order_relaxed) <<
+               " occupancy:";
+        for (int i = 0; i < kOccupancyBuckets; i++)
+        {
+            out << " " << occupancy[i].load(boost::memory_order_relaxed);
+        }
+        return out.str();
+    }
+};
+
+}  // namespace base
+
+#endif  // BASE_QUEUESTATS_H_
@@ -1,18 +1,57 @@
 #ifndef BASE_RUNNABLE_H
 #define BASE_RUNNABLE_H
 
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
 #include <boost/thread.hpp>
 
 namespace base {
 
+class SchedPolicy {
+public:
+    enum value {
+        OTHER,  // default time sharing, niceness applies
+        FIFO    // real time, needs CAP_SYS_NICE
+    };
+};
+
+/**
+ * @brief How the thread of a Runnable is set up before run() is called.
+ * Defaults leave the thread like a plain boost::thread.
+ */
+struct ThreadOptions {
+    ThreadOptions() : policy(SchedPolicy::OTHER), priority(0), nice(0) {
+
+    }
+
+    // shows up in top -H, gdb and perf. Linux truncates it to 15 chars
+    std::string name;
+    // cpus the thread may run on, empty means any
+    std::vector<int> cpus;
+    SchedPolicy::value policy;
+    // SCHED_FIFO priority, 1-99. Only for SchedPolicy::FIFO
+    int priority;
+    // -20 to 19. Only for SchedPolicy::OTHER
+    int nice;
+};
+
 class Runnable {
 public:
     virtual ~Runnable() {
 
     }
 
-    void start() {
-        thread_ = boost::thread(&Runnable::run, this/*, arg*/);
+    void start(const ThreadOptions& options = ThreadOptions()) {
+        options_ = options;
+        thread_ = boost::thread(&Runnable::runWithOptions, this);
     }
 
     void cancel() {
@@ -25,7 +64,50 @@ public:
 
     virtual void run() = 0;
 private:
+    /**
+     * @brief Applies options_ from the new thread and calls run().
+     * A failure (e.g. no permission for SCHED_FIFO or a cpu that doesn't exist)
+     * is reported and the thread runs anyway without that option.
+     */
+    void runWithOptions() {
+        pthread_t self = pthread_self();
+        const char *name = options_.name.empty() ? "runnable" : options_.name.c_str();
+        int err;
+        if(!options_.name.empty()) {
+            // 16 bytes including the terminator or pthread_setname_np fails
+            std::string shortName = options_.name.substr(0, 15);
+            if((err = pthread_setname_np(self, shortName.c_str())) != 0) {
+                printf("%s: can't set thread name: %s\n", name, strerror(err));
+            }
+        }
+        if(!options_.cpus.empty()) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for(size_t i = 0; i < options_.cpus.size(); i++) {
+                CPU_SET(options_.cpus[i], &cpus);
+            }
+            if((err = pthread_setaffinity_np(self, sizeof(cpus), &cpus)) != 0) {
+                printf("%s: can't set cpu affinity: %s\n", name, strerror(err));
+            }
+        }
+        if(options_.policy == SchedPolicy::FIFO) {
+            struct sched_param param;
+            param.sched_priority = options_.priority;
+            if((err = pthread_setschedparam(self, SCHED_FIFO, &param)) != 0) {
+                printf("%s: can't set SCHED_FIFO priority %d: %s\n", name, options_.priority, strerror(err));
+            }
+        } else if(options_.nice != 0) {
+            // on Linux niceness is per thread, PRIO_PROCESS with a thread id only changes that thread
+            pid_t tid = syscall(SYS_gettid);
+            if(setpriority(PRIO_PROCESS, tid, options_.nice) != 0) {
+                printf("%s: can't set nice %d: %s\n", name, options_.nice, strerror(errno));
+            }
+        }
+        run();
+    }
+
     boost::thread thread_;
+    ThreadOptions options_;
 };
 
 } // namespace base
@@ -0,0 +1,181 @@
+#ifndef BASE_SPSCQUEUE_H_
+#define BASE_SPSCQUEUE_H_
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include "base/alignedarray.h"
+#include "base/cacheline.h"
+
+namespace base {
+
+/**
+ * base::SpscQueue is a lock-free alternative to base::ProducerConsumerQueue for the case
+ * where a queue has exactly one producer thread and one consumer thread.
+ * It keeps the same slot API (tryGetWriteSlot()/slotWritten() and tryGetReadSlot()/slotRead())
+ * so it can hold the same base::Block<T> objects.
+ *
+ * Blocks are kept in a ring of numBuffers + 1 positions. The producer is the only one
+ * advancing tail_ and the consumer is the only one advancing head_, so no mutex is needed:
+ * each side publishes its index with a release store and reads the other side's with an
+ * acquire load. Each side also caches the last value it saw from the other side so the
+ * shared cache line is only touched when the ring looks full (or empty).
+ *
+ * Slots are handed out in FIFO order, so at most one write slot and one read slot
+ * can be outstanding at any time.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+
+    SpscQueue() : configured_(false), size_(0), head_(0), cachedTail_(0), tail_(0), cachedHead_(0)
+    {
+    }
+
+    ~SpscQueue()
+    {
+        clean();
+    }
+
+    void clean()
+    {
+        if (configured_)
+        {
+            configured_ = false;
+            blocks_.clear();
+            storage_.clear();
+        }
+    }
+
+    //
+    // must be called before the producer and consumer threads start
+    //
+    void configure(uint32_t numBuffers)
+    {
+        clean();  // clean if previously configured
+
+        // one position is always left empty to tell a full ring from an empty one
+        size_ = numBuffers + 1;
+        blocks_.reserve(size_);
+        storage_.allocate(size_);
+        for (uint32_t i = 0; i < size_; i++)
+        {
+            blocks_.push_back(storage_.get(i));
+        }
+
+        head_.store(0, boost::memory_order_relaxed);
+        tail_.store(0, boost::memory_order_relaxed);
+        cachedHead_ = 0;
+        cachedTail_ = 0;
+        configured_ = true;
+    }
+
+    //
+    // reserve a block (producer side)
+    // returns true on success and false if the queue is full. Never blocks.
+    //
+    bool tryGetWriteSlot(T **block)
+    {
+        const uint32_t tail = tail_.load(boost::memory_order_relaxed);
+        const uint32_t next = nextPosition(tail);
+        if (next == cachedHead_)
+        {
+            cachedHead_ = head_.load(boost::memory_order_acquire);
+            if (next == cachedHead_)
+            {
+                return false;  // full
+            }
+        }
+        *block = blocks_[tail];
+        return true;
+    }
+
+    //
+    // reserve a block, spinning until one is free
+    //
+    void getWriteSlot(T **block)
+    {
+        while (!tryGetWriteSlot(block))
+        {
+            boost::this_thread::yield();
+        }
+    }
+
+    //
+    // publish the block returned by the last tryGetWriteSlot()
+    //
+    void slotWritten(T *block)
+    {
+        const uint32_t tail = tail_.load(boost::memory_order_relaxed);
+        assert(block == blocks_[tail]);
+        tail_.store(nextPosition(tail), boost::memory_order_release);
+    }
+
+    //
+    // get a block with valid data (consumer side)
+    // returns true on success and false if the queue is empty. Never blocks.
+    //
+    bool tryGetReadSlot(T **block)
+    {
+        const uint32_t head = head_.load(boost::memory_order_relaxed);
+        if (head == cachedTail_)
+        {
+            cachedTail_ = tail_.load(boost::memory_order_acquire);
+            if (head == cachedTail_)
+            {
+                return false;  // empty
+            }
+        }
+        *block = blocks_[head];
+        return true;
+    }
+
+    //
+    // get a block with valid data, spinning until one is available
+    //
+    void getReadSlot(T **block)
+    {
+        while (!tryGetReadSlot(block))
+        {
+            boost::this_thread::yield();
+        }
+    }
+
+    //
+    // mark the block returned by the last tryGetReadSlot() as read so the producer can reuse it
+    //
+    void slotRead(T *block)
+    {
+        const uint32_t head = head_.load(boost::memory_order_relaxed);
+        assert(block == blocks_[head]);
+        head_.store(nextPosition(head), boost::memory_order_release);
+    }
+
+private:
+
+    uint32_t nextPosition(uint32_t position) const
+    {
+        return (position + 1 == size_) ? 0 : position + 1;
+    }
+
+    bool configured_;
+    // all the blocks, in one cache line aligned allocation
+    AlignedArray<T> storage_;
+    std::vector<T *> blocks_;
+    uint32_t size_;
+
+    // owned by the consumer
+    BASE_CACHELINE_ALIGNED boost::atomic<uint32_t> head_;
+    uint32_t cachedTail_;
+
+    // owned by the producer
+    BASE_CACHELINE_ALIGNED boost::atomic<uint32_t> tail_;
+    uint32_t cachedHead_;
+};
+
+}  // namespace base
+
+#endif  // BASE_SPSCQUEUE_H_
@@ -0,0 +1,312 @@
+#ifndef BASE_TIMERWHEEL_H_
+#define BASE_TIMERWHEEL_H_
+
+#include <assert.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include <boost/function.hpp>
+
+namespace base {
+
+/**
+ * base::TimerWheel runs callbacks after a number of ticks (the caller decides what a tick is,
+ * e.g. a millisecond). It is meant to be driven from one thread's event loop:
+ * advance() to the current time, then sleep for at most ticksToNextTimer().
+ *
+ * Timers are kept in kLevels wheels of kSlots slots. A timer due in less than kSlots ticks
+ * goes to level 0, one due in less than kSlots^2 ticks to level 1 and so on. When level 0
+ * wraps around, the next slot of level 1 is moved down (cascaded), and so on for the
+ * higher levels. Every slot is a doubly linked list of timers, so schedule() and cancel()
+ * are O(1) and advance() only touches the slots it goes through and the timers that are due.
+ *
+ * Timers live in a pool and are named by a TimerId with a generation number, so cancelling
+ * a timer that already fired (or was cancelled) is a harmless no-op.
+ * Callbacks may schedule and cancel timers, including themselves.
+ */
+class TimerWheel
+{
+public:
+    typedef uint64_t TimerId;
+    typedef boost::function<void()> Callback;
+
+    // never returned by schedule()
+    static const TimerId kNoTimer = 0;
+
+    explicit TimerWheel(uint64_t now = 0) : now_(now), numTimers_(0), freeTimers_(kNone)
+    {
+        slots_.assign(kLevels * kSlots, kNone);
+        for (uint32_t level = 0; level < kLevels; level++)
+        {
+            levelTimers_[level] = 0;
+        }
+    }
+
+    //
+    // monotonic milliseconds, for wheels ticking in milliseconds
+    //
+    static uint64_t nowMillis()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+    }
+
+    //
+    // run callback once delay ticks from the time of the last advance().
+    // A delay of 0 runs it on the next tick
+    //
+    TimerId schedule(uint64_t delay, const Callback &callback)
+    {
+        uint32_t index = allocateTimer();
+        Timer &timer = timers_[index];
+        timer.deadline = now_ + (delay > 0 ? delay : 1);
+        timer.callback = callback;
+        link(index);
+        ++numTimers_;
+        return (static_cast<uint64_t>(timer.generation) << 32) | (index + 1);
+    }
+
+    //
+    // returns false if the timer already fired or was cancelled
+    //
+    bool cancel(TimerId id)
+    {
+        uint32_t index;
+        if (!find(id, &index))
+        {
+            return false;
+        }
+        unlink(index);
+        releaseTimer(index);
+        --numTimers_;
+        return true;
+    }
+
+    //
+    // fire every timer due up to now, in deadline order (timers due in the same tick in any order)
+    //
+    void advance(uint64_t now)
+    {
+        while (now_ < now)
+        {
+            if (numTimers_ == 0)
+            {
+                now_ = now;  // nothing to go through
+                break;
+            }
+            if (levelTimers_[0] == 0)
+            {
+                // nothing can fire before the next cascade, skip to the tick before it
+                uint64_t last = now_ | (kSlots - 1);
+                now_ = last < now ? last : now;
+                if (now_ == now)
+                {
+                    break;
+                }
+            }
+            ++now_;
+            // move down the timers of the higher levels whose slot is now within reach.
+            // Highest level first, its timers can land in the lower slots cascaded next
+            uint32_t levels = 1;
+            while (levels < kLevels && slotIndex(now_, levels - 1) == 0)
+            {
+                levels++;
+            }
+            for (uint32_t level = levels - 1; level > 0; level--)
+            {
+                cascade(level * kSlots + slotIndex(now_, level));
+            }
+            fire(slotIndex(now_, 0));
+        }
+    }
+
+    //
+    // ticks until advance() may have something to do: the next timer due within kSlots ticks
+    // or the next cascade if there are timers further away. -1 (max) if there are no timers
+    //
+    uint64_t ticksToNextTimer() const
+    {
+        if (numTimers_ == 0)
+        {
+            return static_cast<uint64_t>(-1);
+        }
+        uint64_t ticks = static_cast<uint64_t>(-1);
+        if (numTimers_ > levelTimers_[0])
+        {
+            ticks = kSlots - slotIndex(now_, 0);
+        }
+        for (uint64_t i = 1; i < ticks && i < kSlots && levelTimers_[0] > 0; i++)
+        {
+            if (slots_[slotIndex(now_ + i, 0)] != kNone)
+            {
+                return i;
+            }
+        }
+        return ticks;
+    }
+
+    uint64_t now() const
+    {
+        return now_;
+    }
+
+    // number of scheduled timers
+    uint32_t size() const
+    {
+        return numTimers_;
+    }
+
+private:
+    static const uint32_t kBits = 8;
+    static const uint32_t kSlots = 1 << kBits;
+    static const uint32_t kLevels = 4;
+    // an enum and not a static const: vector::assign takes it by reference and this header has
+    // no .cpp to define it in
+    enum { kNone = 0xffffffff };
+
+    struct Timer
+    {
+        Timer() : deadline(0), generation(1), slot(kNone), prev(kNone), next(kNone)
+        {
+        }
+
+        uint64_t deadline;
+        Callback callback;
+        // bumped every time the timer is released, so old TimerIds don't match
+        uint32_t generation;
+        // slot the timer is linked in, kNone if it isn't scheduled
+        uint32_t slot;
+        // neighbours in the slot list, or next free timer in the pool
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    static uint32_t slotIndex(uint64_t tick, uint32_t level)
+    {
+        return (tick >> (level * kBits)) & (kSlots - 1);
+    }
+
+    bool find(TimerId id, uint32_t *index) const
+    {
+        uint32_t low = static_cast<uint32_t>(id);
+        if (low == 0 || low > timers_.size())
+        {
+            return false;
+        }
+        *index = low - 1;
+        const Timer &timer = timers_[*index];
+        return timer.slot != kNone && timer.generation == static_cast<uint32_t>(id >> 32);
+    }
+
+    uint32_t allocateTimer()
+    {
+        if (freeTimers_ == kNone)
+        {
+            timers_.push_back(Timer());
+            return timers_.size() - 1;
+        }
+        uint32_t index = freeTimers_;
+        freeTimers_ = timers_[index].next;
+        return index;
+    }
+
+    void releaseTimer(uint32_t index)
+    {
+        Timer &timer = timers_[index];
+        timer.callback.clear();
+        ++timer.generation;
+        timer.next = freeTimers_;
+        freeTimers_ = index;
+    }
+
+    // put the timer in the slot for its deadline, relative to now_
+    void link(uint32_t index)
+    {
+        Timer &timer = timers_[index];
+        // a cascaded timer can be due right now, it goes to the slot about to fire
+        uint64_t deadline = timer.deadline > now_ ? timer.deadline : now_;
+        uint64_t delta = deadline - now_;
+        uint32_t level = 0;
+        while (level < kLevels - 1 && delta >= (1ULL << ((level + 1) * kBits)))
+        {
+            level++;
+        }
+        if (delta >= (1ULL << (kLevels * kBits)))
+        {
+            // too far, park it in the furthest slot. It gets relinked when that slot cascades
+            deadline = now_ + (1ULL << (kLevels * kBits)) - 1;
+        }
+        uint32_t slot = level * kSlots + slotIndex(deadline, level);
+        ++levelTimers_[level];
+        timer.slot = slot;
+        timer.prev = kNone;
+        timer.next = slots_[slot];
+        if (timer.next != kNone)
+        {
+            timers_[timer.next].prev = index;
+        }
+        slots_[slot] = index;
+    }
+
+    void unlink(uint32_t index)
+    {
+        Timer &timer = timers_[index];
+        if (timer.prev != kNone)
+        {
+            timers_[timer.prev].next = timer.next;
+        }
+        else
+        {
+            slots_[timer.slot] = timer.next;
+        }
+        if (timer.next != kNone)
+        {
+            timers_[timer.next].prev = timer.prev;
+        }
+        --levelTimers_[timer.slot / kSlots];
+        timer.slot = kNone;
+    }
+
+    void cascade(uint32_t slot)
+    {
+        uint32_t index = slots_[slot];
+        slots_[slot] = kNone;
+        while (index != kNone)
+        {
+            uint32_t next = timers_[index].next;
+            --levelTimers_[slot / kSlots];
+            link(index);
+            index = next;
+        }
+    }
+
+    void fire(uint32_t slot)
+    {
+        // take the timers one at a time, the callbacks can change the list
+        while (slots_[slot] != kNone)
+        {
+            uint32_t index = slots_[slot];
+            unlink(index);
+            Callback callback;
+            callback.swap(timers_[index].callback);
+            releaseTimer(index);
+            --numTimers_;
+            callback();
+        }
+    }
+
+    uint64_t now_;
+    uint32_t numTimers_;
+    // number of timers in each level
+    uint32_t levelTimers_[kLevels];
+    // kLevels * kSlots list heads, level by level
+    std::vector<uint32_t> slots_;
+    std::vector<Timer> timers_;
+    // head of the list of unused entries in timers_
+    uint32_t freeTimers_;
+};
+
+}  // namespace base
+
+#endif  // BASE_TIMERWHEEL_H_
@@ -30,6 +30,12 @@ const ::google::protobuf::internal::GeneratedMessageReflection*
 const ::google::protobuf::Descriptor* FetchSplitResponse_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   FetchSplitResponse_reflection_ = NULL;
+const ::google::protobuf::Descriptor* FetchSplitBatchRequest_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  FetchSplitBatchRequest_reflection_ = NULL;
+const ::google::protobuf::Descriptor* FetchSplitBatchResponse_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  FetchSplitBatchResponse_reflection_ = NULL;
 const ::google::protobuf::Descriptor* HeartBeatRequest_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   HeartBeatRequest_reflection_ = NULL;
@@ -54,9 +60,10 @@ void protobuf_AssignDesc_distributor_2eproto() {
       "distributor.proto");
   GOOGLE_CHECK(file != NULL);
   Registration_descriptor_ = file->message_type(0);
-  static const int Registration_offsets_[2] = {
+  static const int Registration_offsets_[3] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Registration, id_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Registration, ipaddress_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Registration, credits_),
   };
   Registration_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -70,8 +77,9 @@ void protobuf_AssignDesc_distributor_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(Registration));
   FetchSplitRequest_descriptor_ = file->message_type(1);
-  static const int FetchSplitRequest_offsets_[1] = {
+  static const int FetchSplitRequest_offsets_[2] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitRequest, filename_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitRequest, id_),
   };
   FetchSplitRequest_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -85,9 +93,10 @@ void protobuf_AssignDesc_distributor_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(FetchSplitRequest));
   FetchSplitResponse_descriptor_ = file->message_type(2);
-  static const int FetchSplitResponse_offsets_[2] = {
+  static const int FetchSplitResponse_offsets_[3] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitResponse, filename_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitResponse, status_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitResponse, id_),
   };
   FetchSplitResponse_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -100,7 +109,38 @@ void protobuf_AssignDesc_distributor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(FetchSplitResponse));
-  HeartBeatRequest_descriptor_ = file->message_type(3);
+  FetchSplitBatchRequest_descriptor_ = file->message_type(3);
+  static const int FetchSplitBatchRequest_offsets_[1] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchRequest, splits_),
+  };
+  FetchSplitBatchRequest_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      FetchSplitBatchRequest_descriptor_,
+      FetchSplitBatchRequest::default_instance_,
+      FetchSplitBatchRequest_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchRequest, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchRequest, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(FetchSplitBatchRequest));
+  FetchSplitBatchResponse_descriptor_ = file->message_type(4);
+  static const int FetchSplitBatchResponse_offsets_[2] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchResponse, splits_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchResponse, credits_),
+  };
+  FetchSplitBatchResponse_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      FetchSplitBatchResponse_descriptor_,
+      FetchSplitBatchResponse::default_instance_,
+      FetchSplitBatchResponse_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchResponse, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FetchSplitBatchResponse, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(FetchSplitBatchResponse));
+  HeartBeatRequest_descriptor_ = file->message_type(5);
   static const int HeartBeatRequest_offsets_[1] = {
   };
   HeartBeatRequest_reflection_ =
@@ -114,7 +154,7 @@ void protobuf_AssignDesc_distributor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(HeartBeatRequest));
-  HeartBeatResponse_descriptor_ = file->message_type(4);
+  HeartBeatResponse_descriptor_ = file->message_type(6);
   static const int HeartBeatResponse_offsets_[1] = {
   };
   HeartBeatResponse_reflection_ =
@@ -128,7 +168,7 @@ void protobuf_AssignDesc_distributor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(HeartBeatResponse));
-  ShutdownRequest_descriptor_ = file->message_type(5);
+  ShutdownRequest_descriptor_ = file->message_type(7);
   static const int ShutdownRequest_offsets_[1] = {
   };
   ShutdownRequest_reflection_ =
@@ -142,8 +182,8 @@ void protobuf_AssignDesc_distributor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(ShutdownRequest));
-  AnyRequest_descriptor_ = file->message_type(6);
-  static const int AnyRequest_offsets_[7] = {
+  AnyRequest_descriptor_ = file->message_type(8);
+  static const int AnyRequest_offsets_[9] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, type_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, registration_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, fetchsplitrequest_),
@@ -151,6 +191,8 @@ void protobuf_AssignDesc_distributor_2eproto() {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, heartbeatrequest_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, heartbeatresponse_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, shutdownrequest_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, fetchsplitbatchrequest_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(AnyRequest, fetchsplitbatchresponse_),
   };
   AnyRequest_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -182,6 +224,10 @@ void protobuf_RegisterTypes(const ::std::string&) {
     FetchSplitRequest_descriptor_, &FetchSplitRequest::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     FetchSplitResponse_descriptor_, &FetchSplitResponse::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    FetchSplitBatchRequest_descriptor_, &FetchSplitBatchRequest::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    FetchSplitBatchResponse_descriptor_, &FetchSplitBatchResponse::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     HeartBeatRequest_descriptor_, &HeartBeatRequest::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
@@ -201,6 +247,10 @@ void protobuf_ShutdownFile_distributor_2eproto() {
   delete FetchSplitRequest_reflection_;
   delete FetchSplitResponse::default_instance_;
   delete FetchSplitResponse_reflection_;
+  delete FetchSplitBatchRequest::default_instance_;
+  delete FetchSplitBatchRequest_reflection_;
+  delete FetchSplitBatchResponse::default_instance_;
+  delete FetchSplitBatchResponse_reflection_;
   delete HeartBeatRequest::default_instance_;
   delete HeartBeatRequest_reflection_;
   delete HeartBeatResponse::default_instance_;
@@ -218,32 +268,44 @@ void protobuf_AddDesc_distributor_2eproto() {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-    "\n\021distributor.proto\022\017ddc.distributor\"-\n\014"
+    "\n\021distributor.proto\022\017ddc.distributor\">\n\014"
     "Registration\022\n\n\002id\030\001 \002(\t\022\021\n\tipAddress\030\002 "
-    "\003(\t\"%\n\021FetchSplitRequest\022\020\n\010filename\030\001 \002"
-    "(\t\"6\n\022FetchSplitResponse\022\020\n\010filename\030\001 \002"
-    "(\t\022\016\n\006status\030\002 \002(\005\"\022\n\020HeartBeatRequest\"\023"
-    "\n\021HeartBeatResponse\"\021\n\017ShutdownRequest\"\273"
-    "\004\n\nAnyRequest\022.\n\004type\030\001 \002(\0162 .ddc.distri"
-    "butor.AnyRequest.Type\0223\n\014registration\030\002 "
-    "\001(\0132\035.ddc.distributor.Registration\022=\n\021fe"
-    "tchSplitRequest\030\003 \001(\0132\".ddc.distributor."
-    "FetchSplitRequest\022\?\n\022fetchSplitResponse\030"
-    "\004 \001(\0132#.ddc.distributor.FetchSplitRespon"
-    "se\022;\n\020heartBeatRequest\030\005 \001(\0132!.ddc.distr"
-    "ibutor.HeartBeatRequest\022=\n\021heartBeatResp"
-    "onse\030\006 \001(\0132\".ddc.distributor.HeartBeatRe"
-    "sponse\0229\n\017shutdownRequest\030\007 \001(\0132 .ddc.di"
-    "stributor.ShutdownRequest\"\220\001\n\004Type\022\020\n\014RE"
-    "GISTRATION\020\001\022\027\n\023FETCH_SPLIT_REQUEST\020\002\022\030\n"
-    "\024FETCH_SPLIT_RESPONSE\020\003\022\025\n\021HEARTBEAT_REQ"
-    "UEST\020\004\022\026\n\022HEARTBEAT_RESPONSE\020\005\022\024\n\020SHUTDO"
-    "WN_REQUEST\020\006", 812);
+    "\003(\t\022\017\n\007credits\030\003 \001(\r\"1\n\021FetchSplitReques"
+    "t\022\020\n\010filename\030\001 \001(\t\022\n\n\002id\030\002 \002(\004\"B\n\022Fetch"
+    "SplitResponse\022\020\n\010filename\030\001 \001(\t\022\016\n\006statu"
+    "s\030\002 \002(\005\022\n\n\002id\030\003 \002(\004\"L\n\026FetchSplitBatchRe"
+    "quest\0222\n\006splits\030\001 \003(\0132\".ddc.distributor."
+    "FetchSplitRequest\"_\n\027FetchSplitBatchResp"
+    "onse\0223\n\006splits\030\001 \003(\0132#.ddc.distributor.F"
+    "etchSplitResponse\022\017\n\007credits\030\002 \001(\r\"\022\n\020He"
+    "artBeatRequest\"\023\n\021HeartBeatResponse\"\021\n\017S"
+    "hutdownRequest\"\216\006\n\nAnyRequest\022.\n\004type\030\001 "
+    "\002(\0162 .ddc.distributor.AnyRequest.Type\0223\n"
+    "\014registration\030\002 \001(\0132\035.ddc.distributor.Re"
+    "gistration\022=\n\021fetchSplitRequest\030\003 \001(\0132\"."
+    "ddc.distributor.FetchSplitRequest\022\?\n\022fet"
+    "chSplitResponse\030\004 \001(\0132#.ddc.distributor."
+    "FetchSplitResponse\022;\n\020heartBeatRequest\030\005"
+    " \001(\0132!.ddc.distributor.HeartBeatRequest\022"
+    "=\n\021heartBeatResponse\030\006 \001(\0132\".ddc.distrib"
+    "utor.HeartBeatResponse\0229\n\017shutdownReques"
+    "t\030\007 \001(\0132 .ddc.distributor.ShutdownReques"
+    "t\022G\n\026fetchSplitBatchRequest\030\010 \001(\0132\'.ddc."
+    "distributor.FetchSplitBatchRequest\022I\n\027fe"
+    "tchSplitBatchResponse\030\t \001(\0132(.ddc.distri"
+    "butor.FetchSplitBatchResponse\"\317\001\n\004Type\022\020"
+    "\n\014REGISTRATION\020\001\022\027\n\023FETCH_SPLIT_REQUEST\020"
+    "\002\022\030\n\024FETCH_SPLIT_RESPONSE\020\003\022\025\n\021HEARTBEAT"
+    "_REQUEST\020\004\022\026\n\022HEARTBEAT_RESPONSE\020\005\022\024\n\020SH"
+    "UTDOWN_REQUEST\020\006\022\035\n\031FETCH_SPLIT_BATCH_RE"
+    "QUEST\020\007\022\036\n\032FETCH_SPLIT_BATCH_RESPONSE\020\010", 1239);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "distributor.proto", &protobuf_RegisterTypes);
   Registration::default_instance_ = new Registration();
   FetchSplitRequest::default_instance_ = new FetchSplitRequest();
   FetchSplitResponse::default_instance_ = new FetchSplitResponse();
+  FetchSplitBatchRequest::default_instance_ = new FetchSplitBatchRequest();
+  FetchSplitBatchResponse::default_instance_ = new FetchSplitBatchResponse();
   HeartBeatRequest::default_instance_ = new HeartBeatRequest();
   HeartBeatResponse::default_instance_ = new HeartBeatResponse();
   ShutdownRequest::default_instance_ = new ShutdownRequest();
@@ -251,6 +313,8 @@ void protobuf_AddDesc_distributor_2eproto() {
   Registration::default_instance_->InitAsDefaultInstance();
   FetchSplitRequest::default_instance_->InitAsDefaultInstance();
   FetchSplitResponse::default_instance_->InitAsDefaultInstance();
+  FetchSplitBatchRequest::default_instance_->InitAsDefaultInstance();
+  FetchSplitBatchResponse::default_instance_->InitAsDefaultInstance();
   HeartBeatRequest::default_instance_->InitAsDefaultInstance();
   HeartBeatResponse::default_instance_->InitAsDefaultInstance();
   ShutdownRequest::default_instance_->InitAsDefaultInstance();
@@ -270,6 +334,7 @@ struct StaticDescriptorInitializer_distributor_2eproto {
 #ifndef _MSC_VER
 const int Registration::kIdFieldNumber;
 const int Registration::kIpAddressFieldNumber;
+const int Registration::kCreditsFieldNumber;
 #endif  // !_MSC_VER
 
 Registration::Registration()
@@ -289,6 +354,7 @@ Registration::Registration(const Registration& from)
 void Registration::SharedCtor() {
   _cached_size_ = 0;
   id_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  credits_ = 0u;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -332,6 +398,7 @@ void Registration::Clear() {
         id_->clear();
       }
     }
+    credits_ = 0u;
   }
   ipaddress_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -375,6 +442,22 @@ bool Registration::MergePartialFromCodedStream(
           goto handle_uninterpreted;
         }
         if (input->ExpectTag(18)) goto parse_ipAddress;
+        if (input->ExpectTag(24)) goto parse_credits;
+        break;
+      }
+
+      // optional uint32 credits = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_credits:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &credits_)));
+          set_has_credits();
+        } else {
+          goto handle_uninterpreted;
+        }
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -415,6 +498,11 @@ void Registration::SerializeWithCachedSizes(
       2, this->ipaddress(i), output);
   }
 
+  // optional uint32 credits = 3;
+  if (has_credits()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(3, this->credits(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -442,6 +530,11 @@ void Registration::SerializeWithCachedSizes(
       WriteStringToArray(2, this->ipaddress(i), target);
   }
 
+  // optional uint32 credits = 3;
+  if (has_credits()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(3, this->credits(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -460,6 +553,13 @@ int Registration::ByteSize() const {
           this->id());
     }
 
+    // optional uint32 credits = 3;
+    if (has_credits()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->credits());
+    }
+
   }
   // repeated string ipAddress = 2;
   total_size += 1 * this->ipaddress_size();
@@ -498,6 +598,9 @@ void Registration::MergeFrom(const Registration& from) {
     if (from.has_id()) {
       set_id(from.id());
     }
+    if (from.has_credits()) {
+      set_credits(from.credits());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -524,6 +627,7 @@ void Registration::Swap(Registration* other) {
   if (other != this) {
     std::swap(id_, other->id_);
     ipaddress_.Swap(&other->ipaddress_);
+    std::swap(credits_, other->credits_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -543,6 +647,7 @@ void Registration::Swap(Registration* other) {
 
 #ifndef _MSC_VER
 const int FetchSplitRequest::kFilenameFieldNumber;
+const int FetchSplitRequest::kIdFieldNumber;
 #endif  // !_MSC_VER
 
 FetchSplitRequest::FetchSplitRequest()
@@ -562,6 +667,7 @@ FetchSplitRequest::FetchSplitRequest(const FetchSplitRequest& from)
 void FetchSplitRequest::SharedCtor() {
   _cached_size_ = 0;
   filename_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  id_ = GOOGLE_ULONGLONG(0);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -605,6 +711,7 @@ void FetchSplitRequest::Clear() {
         filename_->clear();
       }
     }
+    id_ = GOOGLE_ULONGLONG(0);
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
@@ -616,7 +723,7 @@ bool FetchSplitRequest::MergePartialFromCodedStream(
   ::google::protobuf::uint32 tag;
   while ((tag = input->ReadTag()) != 0) {
     switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
-      // required string filename = 1;
+      // optional string filename = 1;
       case 1: {
         if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
             ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
@@ -628,6 +735,22 @@ bool FetchSplitRequest::MergePartialFromCodedStream(
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(16)) goto parse_id;
+        break;
+      }
+
+      // required uint64 id = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_id:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &id_)));
+          set_has_id();
+        } else {
+          goto handle_uninterpreted;
+        }
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -650,7 +773,7 @@ bool FetchSplitRequest::MergePartialFromCodedStream(
 
 void FetchSplitRequest::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
-  // required string filename = 1;
+  // optional string filename = 1;
   if (has_filename()) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
       this->filename().data(), this->filename().length(),
@@ -659,6 +782,11 @@ void FetchSplitRequest::SerializeWithCachedSizes(
       1, this->filename(), output);
   }
 
+  // required uint64 id = 2;
+  if (has_id()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(2, this->id(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -667,7 +795,7 @@ void FetchSplitRequest::SerializeWithCachedSizes(
 
 ::google::protobuf::uint8* FetchSplitRequest::SerializeWithCachedSizesToArray(
     ::google::protobuf::uint8* target) const {
-  // required string filename = 1;
+  // optional string filename = 1;
   if (has_filename()) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
       this->filename().data(), this->filename().length(),
@@ -677,6 +805,11 @@ void FetchSplitRequest::SerializeWithCachedSizes(
         1, this->filename(), target);
   }
 
+  // required uint64 id = 2;
+  if (has_id()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(2, this->id(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -688,13 +821,20 @@ int FetchSplitRequest::ByteSize() const {
   int total_size = 0;
 
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    // required string filename = 1;
+    // optional string filename = 1;
     if (has_filename()) {
       total_size += 1 +
         ::google::protobuf::internal::WireFormatLite::StringSize(
           this->filename());
     }
 
+    // required uint64 id = 2;
+    if (has_id()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->id());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -725,6 +865,9 @@ void FetchSplitRequest::MergeFrom(const FetchSplitRequest& from) {
     if (from.has_filename()) {
       set_filename(from.filename());
     }
+    if (from.has_id()) {
+      set_id(from.id());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -742,7 +885,7 @@ void FetchSplitRequest::CopyFrom(const FetchSplitRequest& from) {
 }
 
 bool FetchSplitRequest::IsInitialized() const {
-  if ((_has_bits_[0] & 0x00000001) != 0x00000001) return false;
+  if ((_has_bits_[0] & 0x00000002) != 0x00000002) return false;
 
   return true;
 }
@@ -750,6 +893,7 @@ bool FetchSplitRequest::IsInitialized() const {
 void FetchSplitRequest::Swap(FetchSplitRequest* other) {
   if (other != this) {
     std::swap(filename_, other->filename_);
+    std::swap(id_, other->id_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -770,6 +914,7 @@ void FetchSplitRequest::Swap(FetchSplitRequest* other) {
 #ifndef _MSC_VER
 const int FetchSplitResponse::kFilenameFieldNumber;
 const int FetchSplitResponse::kStatusFieldNumber;
+const int FetchSplitResponse::kIdFieldNumber;
 #endif  // !_MSC_VER
 
 FetchSplitResponse::FetchSplitResponse()
@@ -790,6 +935,7 @@ void FetchSplitResponse::SharedCtor() {
   _cached_size_ = 0;
   filename_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
   status_ = 0;
+  id_ = GOOGLE_ULONGLONG(0);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -834,6 +980,7 @@ void FetchSplitResponse::Clear() {
       }
     }
     status_ = 0;
+    id_ = GOOGLE_ULONGLONG(0);
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
@@ -845,7 +992,7 @@ bool FetchSplitResponse::MergePartialFromCodedStream(
   ::google::protobuf::uint32 tag;
   while ((tag = input->ReadTag()) != 0) {
     switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
-      // required string filename = 1;
+      // optional string filename = 1;
       case 1: {
         if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
             ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
@@ -873,6 +1020,22 @@ bool FetchSplitResponse::MergePartialFromCodedStream(
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(24)) goto parse_id;
+        break;
+      }
+
+      // required uint64 id = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_id:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &id_)));
+          set_has_id();
+        } else {
+          goto handle_uninterpreted;
+        }
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -895,7 +1058,7 @@ bool FetchSplitResponse::MergePartialFromCodedStream(
 
 void FetchSplitResponse::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
-  // required string filename = 1;
+  // optional string filename = 1;
   if (has_filename()) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
       this->filename().data(), this->filename().length(),
@@ -909,6 +1072,11 @@ void FetchSplitResponse::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteInt32(2, this->status(), output);
   }
 
+  // required uint64 id = 3;
+  if (has_id()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(3, this->id(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -917,7 +1085,7 @@ void FetchSplitResponse::SerializeWithCachedSizes(
 
 ::google::protobuf::uint8* FetchSplitResponse::SerializeWithCachedSizesToArray(
     ::google::protobuf::uint8* target) const {
-  // required string filename = 1;
+  // optional string filename = 1;
   if (has_filename()) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
       this->filename().data(), this->filename().length(),
@@ -932,6 +1100,11 @@ void FetchSplitResponse::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(2, this->status(), target);
   }
 
+  // required uint64 id = 3;
+  if (has_id()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(3, this->id(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -943,7 +1116,7 @@ int FetchSplitResponse::ByteSize() const {
   int total_size = 0;
 
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    // required string filename = 1;
+    // optional string filename = 1;
     if (has_filename()) {
       total_size += 1 +
         ::google::protobuf::internal::WireFormatLite::StringSize(
@@ -957,6 +1130,13 @@ int FetchSplitResponse::ByteSize() const {
           this->status());
     }
 
+    // required uint64 id = 3;
+    if (has_id()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->id());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -990,6 +1170,9 @@ void FetchSplitResponse::MergeFrom(const FetchSplitResponse& from) {
     if (from.has_status()) {
       set_status(from.status());
     }
+    if (from.has_id()) {
+      set_id(from.id());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -1007,7 +1190,7 @@ void FetchSplitResponse::CopyFrom(const FetchSplitResponse& from) {
 }
 
 bool FetchSplitResponse::IsInitialized() const {
-  if ((_has_bits_[0] & 0x00000003) != 0x00000003) return false;
+  if ((_has_bits_[0] & 0x00000006) != 0x00000006) return false;
 
   return true;
 }
@@ -1016,6 +1199,7 @@ void FetchSplitResponse::Swap(FetchSplitResponse* other) {
   if (other != this) {
     std::swap(filename_, other->filename_);
     std::swap(status_, other->status_);
+    std::swap(id_, other->id_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -1031,6 +1215,464 @@ void FetchSplitResponse::Swap(FetchSplitResponse* other) {
 }
 
 
+// ===================================================================
+
+#ifndef _MSC_VER
+const int FetchSplitBatchRequest::kSplitsFieldNumber;
+#endif  // !_MSC_VER
+
+FetchSplitBatchRequest::FetchSplitBatchRequest()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void FetchSplitBatchRequest::InitAsDefaultInstance() {
+}
+
+FetchSplitBatchRequest::FetchSplitBatchRequest(const FetchSplitBatchRequest& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void FetchSplitBatchRequest::SharedCtor() {
+  _cached_size_ = 0;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+FetchSplitBatchRequest::~FetchSplitBatchRequest() {
+  SharedDtor();
+}
+
+void FetchSplitBatchRequest::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void FetchSplitBatchRequest::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* FetchSplitBatchRequest::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return FetchSplitBatchRequest_descriptor_;
+}
+
+const FetchSplitBatchRequest& FetchSplitBatchRequest::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_distributor_2eproto();
+  return *default_instance_;
+}
+
+FetchSplitBatchRequest* FetchSplitBatchRequest::default_instance_ = NULL;
+
+FetchSplitBatchRequest* FetchSplitBatchRequest::New() const {
+  return new FetchSplitBatchRequest;
+}
+
+void FetchSplitBatchRequest::Clear() {
+  splits_.Clear();
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool FetchSplitBatchRequest::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // repeated .ddc.distributor.FetchSplitRequest splits = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_splits:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_splits()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(10)) goto parse_splits;
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void FetchSplitBatchRequest::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // repeated .ddc.distributor.FetchSplitRequest splits = 1;
+  for (int i = 0; i < this->splits_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      1, this->splits(i), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* FetchSplitBatchRequest::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // repeated .ddc.distributor.FetchSplitRequest splits = 1;
+  for (int i = 0; i < this->splits_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        1, this->splits(i), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int FetchSplitBatchRequest::ByteSize() const {
+  int total_size = 0;
+
+  // repeated .ddc.distributor.FetchSplitRequest splits = 1;
+  total_size += 1 * this->splits_size();
+  for (int i = 0; i < this->splits_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->splits(i));
+  }
+
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void FetchSplitBatchRequest::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const FetchSplitBatchRequest* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FetchSplitBatchRequest*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void FetchSplitBatchRequest::MergeFrom(const FetchSplitBatchRequest& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  splits_.MergeFrom(from.splits_);
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void FetchSplitBatchRequest::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void FetchSplitBatchRequest::CopyFrom(const FetchSplitBatchRequest& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool FetchSplitBatchRequest::IsInitialized() const {
+
+  for (int i = 0; i < splits_size(); i++) {
+    if (!this->splits(i).IsInitialized()) return false;
+  }
+  return true;
+}
+
+void FetchSplitBatchRequest::Swap(FetchSplitBatchRequest* other) {
+  if (other != this) {
+    splits_.Swap(&other->splits_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata FetchSplitBatchRequest::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = FetchSplitBatchRequest_descriptor_;
+  metadata.reflection = FetchSplitBatchRequest_reflection_;
+  return metadata;
+}
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int FetchSplitBatchResponse::kSplitsFieldNumber;
+const int FetchSplitBatchResponse::kCreditsFieldNumber;
+#endif  // !_MSC_VER
+
+FetchSplitBatchResponse::FetchSplitBatchResponse()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void FetchSplitBatchResponse::InitAsDefaultInstance() {
+}
+
+FetchSplitBatchResponse::FetchSplitBatchResponse(const FetchSplitBatchResponse& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void FetchSplitBatchResponse::SharedCtor() {
+  _cached_size_ = 0;
+  credits_ = 0u;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+FetchSplitBatchResponse::~FetchSplitBatchResponse() {
+  SharedDtor();
+}
+
+void FetchSplitBatchResponse::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void FetchSplitBatchResponse::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* FetchSplitBatchResponse::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return FetchSplitBatchResponse_descriptor_;
+}
+
+const FetchSplitBatchResponse& FetchSplitBatchResponse::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_distributor_2eproto();
+  return *default_instance_;
+}
+
+FetchSplitBatchResponse* FetchSplitBatchResponse::default_instance_ = NULL;
+
+FetchSplitBatchResponse* FetchSplitBatchResponse::New() const {
+  return new FetchSplitBatchResponse;
+}
+
+void FetchSplitBatchResponse::Clear() {
+  if (_has_bits_[1 / 32] & (0xffu << (1 % 32))) {
+    credits_ = 0u;
+  }
+  splits_.Clear();
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool FetchSplitBatchResponse::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // repeated .ddc.distributor.FetchSplitResponse splits = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_splits:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_splits()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(10)) goto parse_splits;
+        if (input->ExpectTag(16)) goto parse_credits;
+        break;
+      }
+
+      // optional uint32 credits = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_credits:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &credits_)));
+          set_has_credits();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void FetchSplitBatchResponse::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // repeated .ddc.distributor.FetchSplitResponse splits = 1;
+  for (int i = 0; i < this->splits_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      1, this->splits(i), output);
+  }
+
+  // optional uint32 credits = 2;
+  if (has_credits()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(2, this->credits(), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* FetchSplitBatchResponse::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // repeated .ddc.distributor.FetchSplitResponse splits = 1;
+  for (int i = 0; i < this->splits_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        1, this->splits(i), target);
+  }
+
+  // optional uint32 credits = 2;
+  if (has_credits()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(2, this->credits(), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int FetchSplitBatchResponse::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[1 / 32] & (0xffu << (1 % 32))) {
+    // optional uint32 credits = 2;
+    if (has_credits()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->credits());
+    }
+
+  }
+  // repeated .ddc.distributor.FetchSplitResponse splits = 1;
+  total_size += 1 * this->splits_size();
+  for (int i = 0; i < this->splits_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->splits(i));
+  }
+
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void FetchSplitBatchResponse::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const FetchSplitBatchResponse* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FetchSplitBatchResponse*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void FetchSplitBatchResponse::MergeFrom(const FetchSplitBatchResponse& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  splits_.MergeFrom(from.splits_);
+  if (from._has_bits_[1 / 32] & (0xffu << (1 % 32))) {
+    if (from.has_credits()) {
+      set_credits(from.credits());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void FetchSplitBatchResponse::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void FetchSplitBatchResponse::CopyFrom(const FetchSplitBatchResponse& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool FetchSplitBatchResponse::IsInitialized() const {
+
+  for (int i = 0; i < splits_size(); i++) {
+    if (!this->splits(i).IsInitialized()) return false;
+  }
+  return true;
+}
+
+void FetchSplitBatchResponse::Swap(FetchSplitBatchResponse* other) {
+  if (other != this) {
+    splits_.Swap(&other->splits_);
+    std::swap(credits_, other->credits_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata FetchSplitBatchResponse::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = FetchSplitBatchResponse_descriptor_;
+  metadata.reflection = FetchSplitBatchResponse_reflection_;
+  return metadata;
+}
+
+
 // ===================================================================
 
 #ifndef _MSC_VER
@@ -1513,6 +2155,8 @@ bool AnyRequest_Type_IsValid(int value) {
     case 4:
     case 5:
     case 6:
+    case 7:
+    case 8:
       return true;
     default:
       return false;
@@ -1526,6 +2170,8 @@ const AnyRequest_Type AnyRequest::FETCH_SPLIT_RESPONSE;
 const AnyRequest_Type AnyRequest::HEARTBEAT_REQUEST;
 const AnyRequest_Type AnyRequest::HEARTBEAT_RESPONSE;
 const AnyRequest_Type AnyRequest::SHUTDOWN_REQUEST;
+const AnyRequest_Type AnyRequest::FETCH_SPLIT_BATCH_REQUEST;
+const AnyRequest_Type AnyRequest::FETCH_SPLIT_BATCH_RESPONSE;
 const AnyRequest_Type AnyRequest::Type_MIN;
 const AnyRequest_Type AnyRequest::Type_MAX;
 const int AnyRequest::Type_ARRAYSIZE;
@@ -1538,6 +2184,8 @@ const int AnyRequest::kFetchSplitResponseFieldNumber;
 const int AnyRequest::kHeartBeatRequestFieldNumber;
 const int AnyRequest::kHeartBeatResponseFieldNumber;
 const int AnyRequest::kShutdownRequestFieldNumber;
+const int AnyRequest::kFetchSplitBatchRequestFieldNumber;
+const int AnyRequest::kFetchSplitBatchResponseFieldNumber;
 #endif  // !_MSC_VER
 
 AnyRequest::AnyRequest()
@@ -1552,6 +2200,8 @@ void AnyRequest::InitAsDefaultInstance() {
   heartbeatrequest_ = const_cast< ::ddc::distributor::HeartBeatRequest*>(&::ddc::distributor::HeartBeatRequest::default_instance());
   heartbeatresponse_ = const_cast< ::ddc::distributor::HeartBeatResponse*>(&::ddc::distributor::HeartBeatResponse::default_instance());
   shutdownrequest_ = const_cast< ::ddc::distributor::ShutdownRequest*>(&::ddc::distributor::ShutdownRequest::default_instance());
+  fetchsplitbatchrequest_ = const_cast< ::ddc::distributor::FetchSplitBatchRequest*>(&::ddc::distributor::FetchSplitBatchRequest::default_instance());
+  fetchsplitbatchresponse_ = const_cast< ::ddc::distributor::FetchSplitBatchResponse*>(&::ddc::distributor::FetchSplitBatchResponse::default_instance());
 }
 
 AnyRequest::AnyRequest(const AnyRequest& from)
@@ -1569,6 +2219,8 @@ void AnyRequest::SharedCtor() {
   heartbeatrequest_ = NULL;
   heartbeatresponse_ = NULL;
   shutdownrequest_ = NULL;
+  fetchsplitbatchrequest_ = NULL;
+  fetchsplitbatchresponse_ = NULL;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -1584,6 +2236,8 @@ void AnyRequest::SharedDtor() {
     delete heartbeatrequest_;
     delete heartbeatresponse_;
     delete shutdownrequest_;
+    delete fetchsplitbatchrequest_;
+    delete fetchsplitbatchresponse_;
   }
 }
 
@@ -1629,6 +2283,14 @@ void AnyRequest::Clear() {
     if (has_shutdownrequest()) {
       if (shutdownrequest_ != NULL) shutdownrequest_->::ddc::distributor::ShutdownRequest::Clear();
     }
+    if (has_fetchsplitbatchrequest()) {
+      if (fetchsplitbatchrequest_ != NULL) fetchsplitbatchrequest_->::ddc::distributor::FetchSplitBatchRequest::Clear();
+    }
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (has_fetchsplitbatchresponse()) {
+      if (fetchsplitbatchresponse_ != NULL) fetchsplitbatchresponse_->::ddc::distributor::FetchSplitBatchResponse::Clear();
+    }
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
@@ -1740,6 +2402,34 @@ bool AnyRequest::MergePartialFromCodedStream(
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(66)) goto parse_fetchSplitBatchRequest;
+        break;
+      }
+
+      // optional .ddc.distributor.FetchSplitBatchRequest fetchSplitBatchRequest = 8;
+      case 8: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_fetchSplitBatchRequest:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+               input, mutable_fetchsplitbatchrequest()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(74)) goto parse_fetchSplitBatchResponse;
+        break;
+      }
+
+      // optional .ddc.distributor.FetchSplitBatchResponse fetchSplitBatchResponse = 9;
+      case 9: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_fetchSplitBatchResponse:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+               input, mutable_fetchsplitbatchresponse()));
+        } else {
+          goto handle_uninterpreted;
+        }
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -1804,6 +2494,18 @@ void AnyRequest::SerializeWithCachedSizes(
       7, this->shutdownrequest(), output);
   }
 
+  // optional .ddc.distributor.FetchSplitBatchRequest fetchSplitBatchRequest = 8;
+  if (has_fetchsplitbatchrequest()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      8, this->fetchsplitbatchrequest(), output);
+  }
+
+  // optional .ddc.distributor.FetchSplitBatchResponse fetchSplitBatchResponse = 9;
+  if (has_fetchsplitbatchresponse()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      9, this->fetchsplitbatchresponse(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -1860,6 +2562,20 @@ void AnyRequest::SerializeWithCachedSizes(
         7, this->shutdownrequest(), target);
   }
 
+  // optional .ddc.distributor.FetchSplitBatchRequest fetchSplitBatchRequest = 8;
+  if (has_fetchsplitbatchrequest()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        8, this->fetchsplitbatchrequest(), target);
+  }
+
+  // optional .ddc.distributor.FetchSplitBatchResponse fetchSplitBatchResponse = 9;
+  if (has_fetchsplitbatchresponse()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        9, this->fetchsplitbatchresponse(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -1919,6 +2635,22 @@ int AnyRequest::ByteSize() const {
           this->shutdownrequest());
     }
 
+    // optional .ddc.distributor.FetchSplitBatchRequest fetchSplitBatchRequest = 8;
+    if (has_fetchsplitbatchrequest()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+          this->fetchsplitbatchrequest());
+    }
+
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    // optional .ddc.distributor.FetchSplitBatchResponse fetchSplitBatchResponse = 9;
+    if (has_fetchsplitbatchresponse()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+          this->fetchsplitbatchresponse());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -1967,6 +2699,14 @@ void AnyRequest::MergeFrom(const AnyRequest& from) {
     if (from.has_shutdownrequest()) {
       mutable_shutdownrequest()->::ddc::distributor::ShutdownRequest::MergeFrom(from.shutdownrequest());
     }
+    if (from.has_fetchsplitbatchrequest()) {
+      mutable_fetchsplitbatchrequest()->::ddc::distributor::FetchSplitBatchRequest::MergeFrom(from.fetchsplitbatchrequest());
+    }
+  }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from.has_fetchsplitbatchresponse()) {
+      mutable_fetchsplitbatchresponse()->::ddc::distributor::FetchSplitBatchResponse::MergeFrom(from.fetchsplitbatchresponse());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -1995,6 +2735,12 @@ bool AnyRequest::IsInitialized() const {
   if (has_fetchsplitresponse()) {
     if (!this->fetchsplitresponse().IsInitialized()) return false;
   }
+  if (has_fetchsplitbatchrequest()) {
+    if (!this->fetchsplitbatchrequest().IsInitialized()) return false;
+  }
+  if (has_fetchsplitbatchresponse()) {
+    if (!this->fetchsplitbatchresponse().IsInitialized()) return false;
+  }
   return true;
 }
 
@@ -2007,6 +2753,8 @@ void AnyRequest::Swap(AnyRequest* other) {
     std::swap(heartbeatrequest_, other->heartbeatrequest_);
     std::swap(heartbeatresponse_, other->heartbeatresponse_);
     std::swap(shutdownrequest_, other->shutdownrequest_);
+    std::swap(fetchsplitbatchrequest_, other->fetchsplitbatchrequest_);
+    std::swap(fetchsplitbatchresponse_, other->fetchsplitbatchresponse_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
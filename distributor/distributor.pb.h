@@ -38,6 +38,8 @@ void protobuf_ShutdownFile_distributor_2eproto();
 class Registration;
 class FetchSplitRequest;
 class FetchSplitResponse;
+class FetchSplitBatchRequest;
+class FetchSplitBatchResponse;
 class HeartBeatRequest;
 class HeartBeatResponse;
 class ShutdownRequest;
@@ -49,11 +51,13 @@ enum AnyRequest_Type {
   AnyRequest_Type_FETCH_SPLIT_RESPONSE = 3,
   AnyRequest_Type_HEARTBEAT_REQUEST = 4,
   AnyRequest_Type_HEARTBEAT_RESPONSE = 5,
-  AnyRequest_Type_SHUTDOWN_REQUEST = 6
+  AnyRequest_Type_SHUTDOWN_REQUEST = 6,
+  AnyRequest_Type_FETCH_SPLIT_BATCH_REQUEST = 7,
+  AnyRequest_Type_FETCH_SPLIT_BATCH_RESPONSE = 8
 };
 bool AnyRequest_Type_IsValid(int value);
 const AnyRequest_Type AnyRequest_Type_Type_MIN = AnyRequest_Type_REGISTRATION;
-const AnyRequest_Type AnyRequest_Type_Type_MAX = AnyRequest_Type_SHUTDOWN_REQUEST;
+const AnyRequest_Type AnyRequest_Type_Type_MAX = AnyRequest_Type_FETCH_SPLIT_BATCH_RESPONSE;
 const int AnyRequest_Type_Type_ARRAYSIZE = AnyRequest_Type_Type_MAX + 1;
 
 const ::google::protobuf::EnumDescriptor* AnyRequest_Type_descriptor();
@@ -150,18 +154,28 @@ class Registration : public ::google::protobuf::Message {
   inline const ::google::protobuf::RepeatedPtrField< ::std::string>& ipaddress() const;
   inline ::google::protobuf::RepeatedPtrField< ::std::string>* mutable_ipaddress();
 
+  // optional uint32 credits = 3;
+  inline bool has_credits() const;
+  inline void clear_credits();
+  static const int kCreditsFieldNumber = 3;
+  inline ::google::protobuf::uint32 credits() const;
+  inline void set_credits(::google::protobuf::uint32 value);
+
   // @@protoc_insertion_point(class_scope:ddc.distributor.Registration)
  private:
   inline void set_has_id();
   inline void clear_has_id();
+  inline void set_has_credits();
+  inline void clear_has_credits();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
   ::std::string* id_;
   ::google::protobuf::RepeatedPtrField< ::std::string> ipaddress_;
+  ::google::protobuf::uint32 credits_;
 
   mutable int _cached_size_;
-  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
 
   friend void  protobuf_AddDesc_distributor_2eproto();
   friend void protobuf_AssignDesc_distributor_2eproto();
@@ -226,7 +240,7 @@ class FetchSplitRequest : public ::google::protobuf::Message {
 
   // accessors -------------------------------------------------------
 
-  // required string filename = 1;
+  // optional string filename = 1;
   inline bool has_filename() const;
   inline void clear_filename();
   static const int kFilenameFieldNumber = 1;
@@ -238,17 +252,27 @@ class FetchSplitRequest : public ::google::protobuf::Message {
   inline ::std::string* release_filename();
   inline void set_allocated_filename(::std::string* filename);
 
+  // required uint64 id = 2;
+  inline bool has_id() const;
+  inline void clear_id();
+  static const int kIdFieldNumber = 2;
+  inline ::google::protobuf::uint64 id() const;
+  inline void set_id(::google::protobuf::uint64 value);
+
   // @@protoc_insertion_point(class_scope:ddc.distributor.FetchSplitRequest)
  private:
   inline void set_has_filename();
   inline void clear_has_filename();
+  inline void set_has_id();
+  inline void clear_has_id();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
   ::std::string* filename_;
+  ::google::protobuf::uint64 id_;
 
   mutable int _cached_size_;
-  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
 
   friend void  protobuf_AddDesc_distributor_2eproto();
   friend void protobuf_AssignDesc_distributor_2eproto();
@@ -313,7 +337,7 @@ class FetchSplitResponse : public ::google::protobuf::Message {
 
   // accessors -------------------------------------------------------
 
-  // required string filename = 1;
+  // optional string filename = 1;
   inline bool has_filename() const;
   inline void clear_filename();
   static const int kFilenameFieldNumber = 1;
@@ -332,20 +356,30 @@ class FetchSplitResponse : public ::google::protobuf::Message {
   inline ::google::protobuf::int32 status() const;
   inline void set_status(::google::protobuf::int32 value);
 
+  // required uint64 id = 3;
+  inline bool has_id() const;
+  inline void clear_id();
+  static const int kIdFieldNumber = 3;
+  inline ::google::protobuf::uint64 id() const;
+  inline void set_id(::google::protobuf::uint64 value);
+
   // @@protoc_insertion_point(class_scope:ddc.distributor.FetchSplitResponse)
  private:
   inline void set_has_filename();
   inline void clear_has_filename();
   inline void set_has_status();
   inline void clear_has_status();
+  inline void set_has_id();
+  inline void clear_has_id();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
   ::std::string* filename_;
+  ::google::protobuf::uint64 id_;
   ::google::protobuf::int32 status_;
 
   mutable int _cached_size_;
-  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
 
   friend void  protobuf_AddDesc_distributor_2eproto();
   friend void protobuf_AssignDesc_distributor_2eproto();
@@ -356,6 +390,186 @@ class FetchSplitResponse : public ::google::protobuf::Message {
 };
 // -------------------------------------------------------------------
 
+class FetchSplitBatchRequest : public ::google::protobuf::Message {
+ public:
+  FetchSplitBatchRequest();
+  virtual ~FetchSplitBatchRequest();
+
+  FetchSplitBatchRequest(const FetchSplitBatchRequest& from);
+
+  inline FetchSplitBatchRequest& operator=(const FetchSplitBatchRequest& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const FetchSplitBatchRequest& default_instance();
+
+  void Swap(FetchSplitBatchRequest* other);
+
+  // implements Message ----------------------------------------------
+
+  FetchSplitBatchRequest* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const FetchSplitBatchRequest& from);
+  void MergeFrom(const FetchSplitBatchRequest& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // repeated .ddc.distributor.FetchSplitRequest splits = 1;
+  inline int splits_size() const;
+  inline void clear_splits();
+  static const int kSplitsFieldNumber = 1;
+  inline const ::ddc::distributor::FetchSplitRequest& splits(int index) const;
+  inline ::ddc::distributor::FetchSplitRequest* mutable_splits(int index);
+  inline ::ddc::distributor::FetchSplitRequest* add_splits();
+  inline const ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitRequest >&
+      splits() const;
+  inline ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitRequest >*
+      mutable_splits();
+
+  // @@protoc_insertion_point(class_scope:ddc.distributor.FetchSplitBatchRequest)
+ private:
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitRequest > splits_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+
+  friend void  protobuf_AddDesc_distributor_2eproto();
+  friend void protobuf_AssignDesc_distributor_2eproto();
+  friend void protobuf_ShutdownFile_distributor_2eproto();
+
+  void InitAsDefaultInstance();
+  static FetchSplitBatchRequest* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class FetchSplitBatchResponse : public ::google::protobuf::Message {
+ public:
+  FetchSplitBatchResponse();
+  virtual ~FetchSplitBatchResponse();
+
+  FetchSplitBatchResponse(const FetchSplitBatchResponse& from);
+
+  inline FetchSplitBatchResponse& operator=(const FetchSplitBatchResponse& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const FetchSplitBatchResponse& default_instance();
+
+  void Swap(FetchSplitBatchResponse* other);
+
+  // implements Message ----------------------------------------------
+
+  FetchSplitBatchResponse* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const FetchSplitBatchResponse& from);
+  void MergeFrom(const FetchSplitBatchResponse& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // repeated .ddc.distributor.FetchSplitResponse splits = 1;
+  inline int splits_size() const;
+  inline void clear_splits();
+  static const int kSplitsFieldNumber = 1;
+  inline const ::ddc::distributor::FetchSplitResponse& splits(int index) const;
+  inline ::ddc::distributor::FetchSplitResponse* mutable_splits(int index);
+  inline ::ddc::distributor::FetchSplitResponse* add_splits();
+  inline const ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitResponse >&
+      splits() const;
+  inline ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitResponse >*
+      mutable_splits();
+
+  // optional uint32 credits = 2;
+  inline bool has_credits() const;
+  inline void clear_credits();
+  static const int kCreditsFieldNumber = 2;
+  inline ::google::protobuf::uint32 credits() const;
+  inline void set_credits(::google::protobuf::uint32 value);
+
+  // @@protoc_insertion_point(class_scope:ddc.distributor.FetchSplitBatchResponse)
+ private:
+  inline void set_has_credits();
+  inline void clear_has_credits();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitResponse > splits_;
+  ::google::protobuf::uint32 credits_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+
+  friend void  protobuf_AddDesc_distributor_2eproto();
+  friend void protobuf_AssignDesc_distributor_2eproto();
+  friend void protobuf_ShutdownFile_distributor_2eproto();
+
+  void InitAsDefaultInstance();
+  static FetchSplitBatchResponse* default_instance_;
+};
+// -------------------------------------------------------------------
+
 class HeartBeatRequest : public ::google::protobuf::Message {
  public:
   HeartBeatRequest();
@@ -631,6 +845,8 @@ class AnyRequest : public ::google::protobuf::Message {
   static const Type HEARTBEAT_REQUEST = AnyRequest_Type_HEARTBEAT_REQUEST;
   static const Type HEARTBEAT_RESPONSE = AnyRequest_Type_HEARTBEAT_RESPONSE;
   static const Type SHUTDOWN_REQUEST = AnyRequest_Type_SHUTDOWN_REQUEST;
+  static const Type FETCH_SPLIT_BATCH_REQUEST = AnyRequest_Type_FETCH_SPLIT_BATCH_REQUEST;
+  static const Type FETCH_SPLIT_BATCH_RESPONSE = AnyRequest_Type_FETCH_SPLIT_BATCH_RESPONSE;
   static inline bool Type_IsValid(int value) {
     return AnyRequest_Type_IsValid(value);
   }
@@ -715,6 +931,24 @@ class AnyRequest : public ::google::protobuf::Message {
   inline ::ddc::distributor::ShutdownRequest* release_shutdownrequest();
   inline void set_allocated_shutdownrequest(::ddc::distributor::ShutdownRequest* shutdownrequest);
 
+  // optional .ddc.distributor.FetchSplitBatchRequest fetchSplitBatchRequest = 8;
+  inline bool has_fetchsplitbatchrequest() const;
+  inline void clear_fetchsplitbatchrequest();
+  static const int kFetchSplitBatchRequestFieldNumber = 8;
+  inline const ::ddc::distributor::FetchSplitBatchRequest& fetchsplitbatchrequest() const;
+  inline ::ddc::distributor::FetchSplitBatchRequest* mutable_fetchsplitbatchrequest();
+  inline ::ddc::distributor::FetchSplitBatchRequest* release_fetchsplitbatchrequest();
+  inline void set_allocated_fetchsplitbatchrequest(::ddc::distributor::FetchSplitBatchRequest* fetchsplitbatchrequest);
+
+  // optional .ddc.distributor.FetchSplitBatchResponse fetchSplitBatchResponse = 9;
+  inline bool has_fetchsplitbatchresponse() const;
+  inline void clear_fetchsplitbatchresponse();
+  static const int kFetchSplitBatchResponseFieldNumber = 9;
+  inline const ::ddc::distributor::FetchSplitBatchResponse& fetchsplitbatchresponse() const;
+  inline ::ddc::distributor::FetchSplitBatchResponse* mutable_fetchsplitbatchresponse();
+  inline ::ddc::distributor::FetchSplitBatchResponse* release_fetchsplitbatchresponse();
+  inline void set_allocated_fetchsplitbatchresponse(::ddc::distributor::FetchSplitBatchResponse* fetchsplitbatchresponse);
+
   // @@protoc_insertion_point(class_scope:ddc.distributor.AnyRequest)
  private:
   inline void set_has_type();
@@ -731,6 +965,10 @@ class AnyRequest : public ::google::protobuf::Message {
   inline void clear_has_heartbeatresponse();
   inline void set_has_shutdownrequest();
   inline void clear_has_shutdownrequest();
+  inline void set_has_fetchsplitbatchrequest();
+  inline void clear_has_fetchsplitbatchrequest();
+  inline void set_has_fetchsplitbatchresponse();
+  inline void clear_has_fetchsplitbatchresponse();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -740,10 +978,12 @@ class AnyRequest : public ::google::protobuf::Message {
   ::ddc::distributor::HeartBeatRequest* heartbeatrequest_;
   ::ddc::distributor::HeartBeatResponse* heartbeatresponse_;
   ::ddc::distributor::ShutdownRequest* shutdownrequest_;
+  ::ddc::distributor::FetchSplitBatchRequest* fetchsplitbatchrequest_;
+  ::ddc::distributor::FetchSplitBatchResponse* fetchsplitbatchresponse_;
   int type_;
 
   mutable int _cached_size_;
-  ::google::protobuf::uint32 _has_bits_[(7 + 31) / 32];
+  ::google::protobuf::uint32 _has_bits_[(9 + 31) / 32];
 
   friend void  protobuf_AddDesc_distributor_2eproto();
   friend void protobuf_AssignDesc_distributor_2eproto();
@@ -873,11 +1113,33 @@ Registration::mutable_ipaddress() {
   return &ipaddress_;
 }
 
+// optional uint32 credits = 3;
+inline bool Registration::has_credits() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void Registration::set_has_credits() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void Registration::clear_has_credits() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void Registration::clear_credits() {
+  credits_ = 0u;
+  clear_has_credits();
+}
+inline ::google::protobuf::uint32 Registration::credits() const {
+  return credits_;
+}
+inline void Registration::set_credits(::google::protobuf::uint32 value) {
+  set_has_credits();
+  credits_ = value;
+}
+
 // -------------------------------------------------------------------
 
 // FetchSplitRequest
 
-// required string filename = 1;
+// optional string filename = 1;
 inline bool FetchSplitRequest::has_filename() const {
   return (_has_bits_[0] & 0x00000001u) != 0;
 }
@@ -947,11 +1209,33 @@ inline void FetchSplitRequest::set_allocated_filename(::std::string* filename) {
   }
 }
 
+// required uint64 id = 2;
+inline bool FetchSplitRequest::has_id() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void FetchSplitRequest::set_has_id() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void FetchSplitRequest::clear_has_id() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void FetchSplitRequest::clear_id() {
+  id_ = GOOGLE_ULONGLONG(0);
+  clear_has_id();
+}
+inline ::google::protobuf::uint64 FetchSplitRequest::id() const {
+  return id_;
+}
+inline void FetchSplitRequest::set_id(::google::protobuf::uint64 value) {
+  set_has_id();
+  id_ = value;
+}
+
 // -------------------------------------------------------------------
 
 // FetchSplitResponse
 
-// required string filename = 1;
+// optional string filename = 1;
 inline bool FetchSplitResponse::has_filename() const {
   return (_has_bits_[0] & 0x00000001u) != 0;
 }
@@ -1043,6 +1327,108 @@ inline void FetchSplitResponse::set_status(::google::protobuf::int32 value) {
   status_ = value;
 }
 
+// required uint64 id = 3;
+inline bool FetchSplitResponse::has_id() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void FetchSplitResponse::set_has_id() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void FetchSplitResponse::clear_has_id() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void FetchSplitResponse::clear_id() {
+  id_ = GOOGLE_ULONGLONG(0);
+  clear_has_id();
+}
+inline ::google::protobuf::uint64 FetchSplitResponse::id() const {
+  return id_;
+}
+inline void FetchSplitResponse::set_id(::google::protobuf::uint64 value) {
+  set_has_id();
+  id_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// FetchSplitBatchRequest
+
+// repeated .ddc.distributor.FetchSplitRequest splits = 1;
+inline int FetchSplitBatchRequest::splits_size() const {
+  return splits_.size();
+}
+inline void FetchSplitBatchRequest::clear_splits() {
+  splits_.Clear();
+}
+inline const ::ddc::distributor::FetchSplitRequest& FetchSplitBatchRequest::splits(int index) const {
+  return splits_.Get(index);
+}
+inline ::ddc::distributor::FetchSplitRequest* FetchSplitBatchRequest::mutable_splits(int index) {
+  return splits_.Mutable(index);
+}
+inline ::ddc::distributor::FetchSplitRequest* FetchSplitBatchRequest::add_splits() {
+  return splits_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitRequest >&
+FetchSplitBatchRequest::splits() const {
+  return splits_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitRequest >*
+FetchSplitBatchRequest::mutable_splits() {
+  return &splits_;
+}
+
+// -------------------------------------------------------------------
+
+// FetchSplitBatchResponse
+
+// repeated .ddc.distributor.FetchSplitResponse splits = 1;
+inline int FetchSplitBatchResponse::splits_size() const {
+  return splits_.size();
+}
+inline void FetchSplitBatchResponse::clear_splits() {
+  splits_.Clear();
+}
+inline const ::ddc::distributor::FetchSplitResponse& FetchSplitBatchResponse::splits(int index) const {
+  return splits_.Get(index);
+}
+inline ::ddc::distributor::FetchSplitResponse* FetchSplitBatchResponse::mutable_splits(int index) {
+  return splits_.Mutable(index);
+}
+inline ::ddc::distributor::FetchSplitResponse* FetchSplitBatchResponse::add_splits() {
+  return splits_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitResponse >&
+FetchSplitBatchResponse::splits() const {
+  return splits_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::ddc::distributor::FetchSplitResponse >*
+FetchSplitBatchResponse::mutable_splits() {
+  return &splits_;
+}
+
+// optional uint32 credits = 2;
+inline bool FetchSplitBatchResponse::has_credits() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void FetchSplitBatchResponse::set_has_credits() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void FetchSplitBatchResponse::clear_has_credits() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void FetchSplitBatchResponse::clear_credits() {
+  credits_ = 0u;
+  clear_has_credits();
+}
+inline ::google::protobuf::uint32 FetchSplitBatchResponse::credits() const {
+  return credits_;
+}
+inline void FetchSplitBatchResponse::set_credits(::google::protobuf::uint32 value) {
+  set_has_credits();
+  credits_ = value;
+}
+
 // -------------------------------------------------------------------
 
 // HeartBeatRequest
@@ -1310,6 +1696,82 @@ inline void AnyRequest::set_allocated_shutdownrequest(::ddc::distributor::Shutdo
   }
 }
 
+// optional .ddc.distributor.FetchSplitBatchRequest fetchSplitBatchRequest = 8;
+inline bool AnyRequest::has_fetchsplitbatchrequest() const {
+  return (_has_bits_[0] & 0x00000080u) != 0;
+}
+inline void AnyRequest::set_has_fetchsplitbatchrequest() {
+  _has_bits_[0] |= 0x00000080u;
+}
+inline void AnyRequest::clear_has_fetchsplitbatchrequest() {
+  _has_bits_[0] &= ~0x00000080u;
+}
+inline void AnyRequest::clear_fetchsplitbatchrequest() {
+  if (fetchsplitbatchrequest_ != NULL) fetchsplitbatchrequest_->::ddc::distributor::FetchSplitBatchRequest::Clear();
+  clear_has_fetchsplitbatchrequest();
+}
+inline const ::ddc::distributor::FetchSplitBatchRequest& AnyRequest::fetchsplitbatchrequest() const {
+  return fetchsplitbatchrequest_ != NULL ? *fetchsplitbatchrequest_ : *default_instance_->fetchsplitbatchrequest_;
+}
+inline ::ddc::distributor::FetchSplitBatchRequest* AnyRequest::mutable_fetchsplitbatchrequest() {
+  set_has_fetchsplitbatchrequest();
+  if (fetchsplitbatchrequest_ == NULL) fetchsplitbatchrequest_ = new ::ddc::distributor::FetchSplitBatchRequest;
+  return fetchsplitbatchrequest_;
+}
+inline ::ddc::distributor::FetchSplitBatchRequest* AnyRequest::release_fetchsplitbatchrequest() {
+  clear_has_fetchsplitbatchrequest();
+  ::ddc::distributor::FetchSplitBatchRequest* temp = fetchsplitbatchrequest_;
+  fetchsplitbatchrequest_ = NULL;
+  return temp;
+}
+inline void AnyRequest::set_allocated_fetchsplitbatchrequest(::ddc::distributor::FetchSplitBatchRequest* fetchsplitbatchrequest) {
+  delete fetchsplitbatchrequest_;
+  fetchsplitbatchrequest_ = fetchsplitbatchrequest;
+  if (fetchsplitbatchrequest) {
+    set_has_fetchsplitbatchrequest();
+  } else {
+    clear_has_fetchsplitbatchrequest();
+  }
+}
+
+// optional .ddc.distributor.FetchSplitBatchResponse fetchSplitBatchResponse = 9;
+inline bool AnyRequest::has_fetchsplitbatchresponse() const {
+  return (_has_bits_[0] & 0x00000100u) != 0;
+}
+inline void AnyRequest::set_has_fetchsplitbatchresponse() {
+  _has_bits_[0] |= 0x00000100u;
+}
+inline void AnyRequest::clear_has_fetchsplitbatchresponse() {
+  _has_bits_[0] &= ~0x00000100u;
+}
+inline void AnyRequest::clear_fetchsplitbatchresponse() {
+  if (fetchsplitbatchresponse_ != NULL) fetchsplitbatchresponse_->::ddc::distributor::FetchSplitBatchResponse::Clear();
+  clear_has_fetchsplitbatchresponse();
+}
+inline const ::ddc::distributor::FetchSplitBatchResponse& AnyRequest::fetchsplitbatchresponse() const {
+  return fetchsplitbatchresponse_ != NULL ? *fetchsplitbatchresponse_ : *default_instance_->fetchsplitbatchresponse_;
+}
+inline ::ddc::distributor::FetchSplitBatchResponse* AnyRequest::mutable_fetchsplitbatchresponse() {
+  set_has_fetchsplitbatchresponse();
+  if (fetchsplitbatchresponse_ == NULL) fetchsplitbatchresponse_ = new ::ddc::distributor::FetchSplitBatchResponse;
+  return fetchsplitbatchresponse_;
+}
+inline ::ddc::distributor::FetchSplitBatchResponse* AnyRequest::release_fetchsplitbatchresponse() {
+  clear_has_fetchsplitbatchresponse();
+  ::ddc::distributor::FetchSplitBatchResponse* temp = fetchsplitbatchresponse_;
+  fetchsplitbatchresponse_ = NULL;
+  return temp;
+}
+inline void AnyRequest::set_allocated_fetchsplitbatchresponse(::ddc::distributor::FetchSplitBatchResponse* fetchsplitbatchresponse) {
+  delete fetchsplitbatchresponse_;
+  fetchsplitbatchresponse_ = fetchsplitbatchresponse;
+  if (fetchsplitbatchresponse) {
+    set_has_fetchsplitbatchresponse();
+  } else {
+    clear_has_fetchsplitbatchresponse();
+  }
+}
+
 
 // @@protoc_insertion_point(namespace_scope)
 
@@ -0,0 +1,363 @@
+
+#include "distributor/journal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <glog/logging.h>
+
+namespace ddc {
+namespace distributor {
+
+namespace {
+
+// by split, the last record of a split wins
+template<typename T>
+bool splitLess(const T& a, const T& b) {
+    return a.split < b.split;
+}
+
+Status::value toStatus(uint32_t type) {
+    return (type == JournalRecordType::OK) ? Status::OK : Status::ERROR;
+}
+
+}  // namespace
+
+SplitJournal::SplitJournal(const std::string& path) :
+    path_(path),
+    fd_(-1),
+    bytes_(0),
+    watermark_(0),
+    replayedPrefixHash_(0),
+    replayedIndex_(0),
+    prefixHash_(kHashBasis_),
+    hashedThrough_(0)
+{
+
+}
+
+SplitJournal::~SplitJournal() {
+    if(fd_ >= 0) {
+        sync();
+        close(fd_);
+    }
+}
+
+uint32_t SplitJournal::checksum(uint64_t split, uint32_t type, uint32_t name) {
+    return static_cast<uint32_t>(split) ^ static_cast<uint32_t>(split >> 32) ^ (type * 0x9e3779b9u) ^
+           (name * 0x85ebca6bu) ^ kMagic_;
+}
+
+uint32_t SplitJournal::nameHash(const std::string& name) {
+    uint32_t hash = kHashBasis_;
+    for(size_t i = 0; i < name.size(); i++) {
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * kHashPrime_;
+    }
+    return hash;
+}
+
+uint32_t SplitJournal::prefixHash(uint32_t prefix, uint32_t name) {
+    for(int i = 0; i < 4; i++) {
+        prefix = (prefix ^ ((name >> (8 * i)) & 0xff)) * kHashPrime_;
+    }
+    return prefix;
+}
+
+bool SplitJournal::open() {
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if(fd < 0) {
+        if(errno != ENOENT) {
+            LOG(ERROR) << "can't open journal " << path_ << ": " << strerror(errno);
+            return false;
+        }
+        // new job
+        std::vector<Done> none;
+        if(!createFile(path_, 0, prefixHash_, none)) {
+            return false;
+        }
+        bytes_ = sizeof(Header);
+    }
+    else {
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            LOG(ERROR) << "can't stat journal " << path_ << ": " << strerror(errno);
+            close(fd);
+            return false;
+        }
+        uint64_t validBytes = 0;
+        bool ok = false;
+        if(st.st_size >= static_cast<off_t>(sizeof(Header))) {
+            void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data == MAP_FAILED) {
+                LOG(ERROR) << "can't map journal " << path_ << ": " << strerror(errno);
+            }
+            else {
+                madvise(data, st.st_size, MADV_SEQUENTIAL);
+                ok = replay(static_cast<const char*>(data), st.st_size, &validBytes);
+                munmap(data, st.st_size);
+            }
+        }
+        else {
+            LOG(ERROR) << "journal " << path_ << " is too short";
+        }
+        close(fd);
+        if(!ok) {
+            return false;
+        }
+        // drop a torn record at the end
+        if(validBytes < static_cast<uint64_t>(st.st_size)) {
+            LOG(ERROR) << "dropping " << st.st_size - validBytes << " bytes at the end of journal " << path_;
+            if(truncate(path_.c_str(), validBytes) != 0) {
+                LOG(ERROR) << "can't truncate journal " << path_ << ": " << strerror(errno);
+                return false;
+            }
+        }
+        bytes_ = validBytes;
+    }
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_APPEND);
+    if(fd_ < 0) {
+        LOG(ERROR) << "can't open journal " << path_ << " for writing: " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool SplitJournal::replay(const char* data, uint64_t size, uint64_t* validBytes) {
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != kMagic_) {
+        LOG(ERROR) << path_ << " is not a split journal";
+        return false;
+    }
+    if(header.version != kVersion_) {
+        LOG(ERROR) << "journal " << path_ << " has version " << header.version << ", expected " << kVersion_;
+        return false;
+    }
+    watermark_ = header.watermark;
+    replayedPrefixHash_ = header.prefixHash;
+
+    uint64_t dispatched = 0;
+    uint64_t offset = sizeof(Header);
+    Record record;
+    for(; offset + sizeof(Record) <= size; offset += sizeof(Record)) {
+        memcpy(&record, data + offset, sizeof(record));
+        if(record.check != checksum(record.split, record.type, record.name)) {
+            break;
+        }
+        if(record.type == JournalRecordType::DISPATCHED) {
+            ++dispatched;
+        }
+        else if((record.split >= watermark_) || (record.type == JournalRecordType::ERROR)) {
+            replayed_.push_back(Done(record.split, toStatus(record.type), record.name));
+        }
+    }
+    *validBytes = offset;
+
+    // sorted, one entry per split
+    std::stable_sort(replayed_.begin(), replayed_.end(), splitLess<Done>);
+    size_t last = 0;
+    for(size_t i = 0; i < replayed_.size(); i++) {
+        if((last > 0) && (replayed_[last - 1].split == replayed_[i].split)) {
+            replayed_[last - 1] = replayed_[i];
+        }
+        else {
+            replayed_[last++] = replayed_[i];
+        }
+    }
+    replayed_.resize(last, Done(0, Status::PENDING, 0));
+    for(size_t i = 0; i < replayed_.size(); i++) {
+        if(replayed_[i].status == Status::ERROR) {
+            errors_.push_back(replayed_[i]);
+        }
+    }
+
+    LOG(INFO) << "replayed journal " << path_ << ": splits below " << watermark_ << " are done, " << replayed_.size() << " splits have records, " <<
+                 errors_.size() << " of them failed, " << dispatched << " dispatches";
+    return true;
+}
+
+bool SplitJournal::replayedStatus(SplitId split, const std::string& name, Status::value* status) {
+    uint32_t hash = nameHash(name);
+    while((replayedIndex_ < replayed_.size()) && (replayed_[replayedIndex_].split < split)) {
+        ++replayedIndex_;
+    }
+    const Done* replayed = NULL;
+    if((replayedIndex_ < replayed_.size()) && (replayed_[replayedIndex_].split == split)) {
+        replayed = &replayed_[replayedIndex_];
+        if(replayed->name != hash) {
+            LOG(ERROR) << "split " << split << " (" << name << ") isn't the split journal " << path_ << " has under that id";
+            return false;
+        }
+    }
+    if(split < watermark_) {
+        // below the watermark only the failed splits have records, the rest is checked as a whole
+        prefixHash_ = prefixHash(prefixHash_, hash);
+        hashedThrough_ = split + 1;
+        if((hashedThrough_ == watermark_) && (prefixHash_ != replayedPrefixHash_)) {
+            LOG(ERROR) << "the splits below " << watermark_ << " aren't the ones journal " << path_ << " has";
+            return false;
+        }
+        *status = (replayed != NULL) ? replayed->status : Status::OK;
+    }
+    else {
+        nameHashes_.push_back(hash);
+        *status = (replayed != NULL) ? replayed->status : Status::PENDING;
+    }
+    return true;
+}
+
+uint32_t SplitJournal::seenName(SplitId split) const {
+    if((split < hashedThrough_) || (split - hashedThrough_ >= nameHashes_.size())) {
+        LOG(ERROR) << "split " << split << " wasn't passed to replayedStatus()";
+        return 0;
+    }
+    return nameHashes_[split - hashedThrough_];
+}
+
+bool SplitJournal::hashNamesBelow(SplitId watermark) {
+    while((hashedThrough_ < watermark) && !nameHashes_.empty()) {
+        prefixHash_ = prefixHash(prefixHash_, nameHashes_.front());
+        nameHashes_.pop_front();
+        ++hashedThrough_;
+    }
+    return hashedThrough_ == watermark;
+}
+
+void SplitJournal::append(SplitId split, JournalRecordType::value type) {
+    Record record;
+    record.split = split;
+    record.type = type;
+    record.name = seenName(split);
+    record.check = checksum(split, type, record.name);
+    record.reserved = 0;
+    buffer_.push_back(record);
+    if(type == JournalRecordType::ERROR) {
+        errors_.push_back(Done(split, Status::ERROR, record.name));
+    }
+}
+
+bool SplitJournal::sync() {
+    if((fd_ < 0) || buffer_.empty()) {
+        return true;
+    }
+    size_t size = buffer_.size() * sizeof(Record);
+    bool ok = writeAll(fd_, reinterpret_cast<const char*>(&buffer_[0]), size);
+    buffer_.clear();
+    if(!ok) {
+        LOG(ERROR) << "can't write journal " << path_ << ": " << strerror(errno);
+        return false;
+    }
+    bytes_ += size;
+    if(fdatasync(fd_) != 0) {
+        LOG(ERROR) << "can't sync journal " << path_ << ": " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool SplitJournal::compact(SplitId watermark, const std::vector<std::pair<SplitId, Status::value> >& done) {
+    if(!hashNamesBelow(watermark)) {
+        LOG(ERROR) << "can't compact journal " << path_ << " at " << watermark << ", the names of the splits before " <<
+                      hashedThrough_ << " are hashed";
+        return false;
+    }
+    // whatever is buffered is covered by watermark and done
+    buffer_.clear();
+    std::vector<Done> kept;
+    for(size_t i = 0; i < done.size(); i++) {
+        kept.push_back(Done(done[i].first, done[i].second, seenName(done[i].first)));
+    }
+    for(size_t i = replayedIndex_; i < replayed_.size(); i++) {
+        if(replayed_[i].split >= watermark) {
+            kept.push_back(replayed_[i]);
+        }
+    }
+    // the watermark alone would turn them into OK
+    for(size_t i = 0; i < errors_.size(); i++) {
+        if(errors_[i].split < watermark) {
+            kept.push_back(errors_[i]);
+        }
+    }
+    if(!createFile(path_ + ".tmp", watermark, prefixHash_, kept)) {
+        return false;
+    }
+    if(rename((path_ + ".tmp").c_str(), path_.c_str()) != 0) {
+        LOG(ERROR) << "can't replace journal " << path_ << ": " << strerror(errno);
+        return false;
+    }
+    // make the rename durable
+    std::string::size_type slash = path_.rfind('/');
+    std::string dir = (slash == std::string::npos) ? "." : path_.substr(0, slash + 1);
+    int dirFd = ::open(dir.c_str(), O_RDONLY);
+    if(dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+
+    int fd = ::open(path_.c_str(), O_WRONLY | O_APPEND);
+    if(fd < 0) {
+        LOG(ERROR) << "can't open journal " << path_ << " for writing: " << strerror(errno);
+        return false;
+    }
+    LOG(INFO) << "compacted journal " << path_ << " from " << bytes_ << " to " <<
+                 sizeof(Header) + kept.size() * sizeof(Record) << " bytes";
+    if(fd_ >= 0) {
+        close(fd_);
+    }
+    fd_ = fd;
+    bytes_ = sizeof(Header) + kept.size() * sizeof(Record);
+    return true;
+}
+
+bool SplitJournal::createFile(const std::string& path, SplitId watermark, uint32_t namesHash,
+                              const std::vector<Done>& done) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        LOG(ERROR) << "can't create journal " << path << ": " << strerror(errno);
+        return false;
+    }
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = kMagic_;
+    header.version = kVersion_;
+    header.watermark = watermark;
+    header.prefixHash = namesHash;
+    std::vector<char> data(sizeof(Header) + done.size() * sizeof(Record));
+    memcpy(&data[0], &header, sizeof(header));
+    for(size_t i = 0; i < done.size(); i++) {
+        Record record;
+        record.split = done[i].split;
+        record.type = (done[i].status == Status::OK) ? JournalRecordType::OK : JournalRecordType::ERROR;
+        record.name = done[i].name;
+        record.check = checksum(record.split, record.type, record.name);
+        record.reserved = 0;
+        memcpy(&data[sizeof(Header) + i * sizeof(Record)], &record, sizeof(record));
+    }
+    bool ok = writeAll(fd, &data[0], data.size()) && (fdatasync(fd) == 0);
+    if(!ok) {
+        LOG(ERROR) << "can't write journal " << path << ": " << strerror(errno);
+    }
+    close(fd);
+    return ok;
+}
+
+bool SplitJournal::writeAll(int fd, const char* data, size_t size) {
+    while(size > 0) {
+        ssize_t written = write(fd, data, size);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+} // namespace distributor
+} // namespace ddc
@@ -0,0 +1,177 @@
+#ifndef DDC_DISTRIBUTOR_JOURNAL_H
+#define DDC_DISTRIBUTOR_JOURNAL_H
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "split.h"
+
+namespace ddc {
+namespace distributor {
+
+class JournalRecordType {
+public:
+    enum value {
+        DISPATCHED = 1,
+        OK = 2,
+        ERROR = 3
+    };
+};
+
+/**
+ * @brief The SplitJournal class is a write-ahead log of split state transitions so a master
+ * that is restarted on the same job doesn't run the finished splits again.
+ *
+ * The file is a header with a watermark (every split below it is done, and OK unless it has an
+ * ERROR record) followed by fixed size records {split, type, hash of the split name}. Records are
+ * buffered and written with one write() + fdatasync() per sync(), so a crash loses at most the
+ * transitions since the last sync and those splits run again.
+ * A torn record at the end of the file is dropped on replay.
+ *
+ * Split ids are the order the SplitSource returns splits in, so the job must be restarted with
+ * the same splits in the same order. The header keeps a hash of the names of all the splits below
+ * the watermark and every record the hash of its split's name, so replayedStatus() notices a
+ * different manifest or directory instead of skipping the wrong splits.
+ *
+ * Not thread safe, it belongs to the master thread.
+ */
+class SplitJournal {
+public:
+    explicit SplitJournal(const std::string& path);
+    ~SplitJournal();
+
+    /**
+     * @brief open Replays the journal at path if there is one (mmapped) and opens it for appending
+     * @return false if the journal can't be read or written
+     */
+    bool open();
+
+    /**
+     * @brief replayedStatus Sets status to OK or ERROR if split finished in a previous run, PENDING if it has to run.
+     * Must be called for every split, in order, before any record of it is appended
+     * @param name of the split, empty if the source doesn't name splits
+     * @return false if split isn't the one the journal has under that id, the journal belongs to other splits
+     */
+    bool replayedStatus(SplitId split, const std::string& name, Status::value* status);
+    /**
+     * @brief watermark Every split below it finished in a previous run, the failed ones have ERROR records
+     */
+    SplitId watermark() const { return watermark_; }
+
+    /**
+     * @brief append Buffers a record, written on the next sync(). split must have been passed to replayedStatus()
+     */
+    void append(SplitId split, JournalRecordType::value type);
+    /**
+     * @brief sync Writes the buffered records and waits for them to reach the disk
+     */
+    bool sync();
+
+    /**
+     * @brief bytes Size of the journal file
+     */
+    uint64_t bytes() const { return bytes_; }
+
+    /**
+     * @brief compact Rewrites the journal as watermark plus the splits at or above it that are done.
+     * Replayed splits that haven't been asked for with replayedStatus() yet are kept, and so are
+     * the ERROR records below watermark so the failed splits aren't replayed as OK.
+     * The new file replaces the old one with a rename, so a crash leaves one or the other
+     * @param done {split, OK or ERROR} for the finished splits at or above watermark
+     */
+    bool compact(SplitId watermark, const std::vector<std::pair<SplitId, Status::value> >& done);
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t watermark;
+        // nameHash() of the names of the splits below watermark, in order
+        uint32_t prefixHash;
+        uint32_t reserved;
+    };
+
+    struct Record {
+        uint64_t split;
+        uint32_t type;
+        // nameHash() of the split's name
+        uint32_t name;
+        // catches garbage at the end of the file after a crash
+        uint32_t check;
+        uint32_t reserved;
+    };
+
+    // a split that finished, as written in its record
+    struct Done {
+        Done(SplitId _split, Status::value _status, uint32_t _name) :
+            split(_split),
+            status(_status),
+            name(_name)
+        {
+
+        }
+
+        SplitId split;
+        Status::value status;
+        uint32_t name;
+    };
+
+    static const uint32_t kMagic_ = 0x4a434444; // "DDCJ"
+    static const uint32_t kVersion_ = 2;
+
+    // FNV-1a
+    static const uint32_t kHashBasis_ = 2166136261u;
+    static const uint32_t kHashPrime_ = 16777619u;
+
+    static uint32_t checksum(uint64_t split, uint32_t type, uint32_t name);
+    static uint32_t nameHash(const std::string& name);
+    /**
+     * @brief prefixHash Adds the nameHash() of the next split to the hash of the splits before it
+     */
+    static uint32_t prefixHash(uint32_t prefix, uint32_t name);
+
+    bool replay(const char* data, uint64_t size, uint64_t* validBytes);
+    bool writeAll(int fd, const char* data, size_t size);
+    bool createFile(const std::string& path, SplitId watermark, uint32_t namesHash, const std::vector<Done>& done);
+    /**
+     * @brief seenName nameHash() of a split passed to replayedStatus() and not below hashedThrough_
+     */
+    uint32_t seenName(SplitId split) const;
+    /**
+     * @brief hashNamesBelow Folds the names of the splits below watermark into prefixHash_
+     * @return false if some of them weren't passed to replayedStatus() or were already folded past watermark
+     */
+    bool hashNamesBelow(SplitId watermark);
+
+    std::string path_;
+    int fd_;
+    uint64_t bytes_;
+    // records not written yet
+    std::vector<Record> buffer_;
+
+    SplitId watermark_;
+    // prefixHash of the replayed header, checked once replayedStatus() reaches watermark_
+    uint32_t replayedPrefixHash_;
+    // the splits that finished before the restart: the ones at or above watermark_
+    // and the ones below it that failed. Sorted
+    std::vector<Done> replayed_;
+    // next entry of replayed_ for replayedStatus()
+    size_t replayedIndex_;
+    // every split with an ERROR record, replayed or appended. Failing is final, so these are
+    // written again below the watermark on every compaction
+    std::vector<Done> errors_;
+
+    // nameHash() of the names of the splits below hashedThrough_
+    uint32_t prefixHash_;
+    SplitId hashedThrough_;
+    // nameHash() of the splits from hashedThrough_ on that were passed to replayedStatus()
+    std::deque<uint32_t> nameHashes_;
+};
+
+} // namespace distributor
+} // namespace ddc
+
+#endif // DDC_DISTRIBUTOR_JOURNAL_H
@@ -1,230 +1,872 @@
 
 #include "master.h"
-#include <boost/format.hpp>
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <algorithm>
+#include <boost/bind.hpp>
 #include <glog/logging.h>
 
 namespace ddc {
 namespace distributor {
 
+const double Master::kBlacklistFailureRate_ = 0.5;
+// std::min and std::max take them by reference
+const uint64_t Master::kHeartBeatSendFrequency_;
+const uint64_t Master::kMinQueueCapacity_;
+const uint64_t Master::kMaxQueueCapacity_;
+
 Master::Master(base::ProducerConsumerQueue<base::Block<FullRequest> >* requestQueue,
+          base::ProducerConsumerQueue<base::Block<FullRequest> >* controlQueue,
           base::ProducerConsumerQueue<base::Block<FullRequest> >* responseQueue,
-          const uint64_t numRequests) :
+          SplitSource* splits,
+          SchedulerPolicy::value schedulerPolicy) :
     requestQueue_(requestQueue),
+    controlQueue_(controlQueue),
     responseQueue_(responseQueue),
-    requestsLeft_(numRequests),
-    responsesLeft_(numRequests),
+    responsesLeft_(0),
     numSplitRequests_(0),
     numSplitResponses_(0),
+    numBatchRequests_(0),
+    numBatchResponses_(0),
     numHeartBeatRequests_(0),
     numHeartBeatResponses_(0),
+    numHeartBeatsSkipped_(0),
     numRegistrations_(0),
-    index_(0),
-    heartBeatIndex_(0)
+    lastNumBatchResponses_(0),
+    heartBeatIndex_(0),
+    scheduler_(Scheduler::create(schedulerPolicy)),
+    source_(splits),
+    sourceDone_(false),
+    firstSplit_(0),
+    numOkSplits_(0),
+    numErrorSplits_(0),
+    timers_(base::TimerWheel::nowMillis()),
+    lackOfProgressTimer_(base::TimerWheel::kNoTimer),
+    lackOfProgress_(false),
+    lastQueueResizeMillis_(0),
+    numBackupsInFlight_(0),
+    numBackupRequests_(0),
+    numBackupWins_(0),
+    numRetries_(0),
+    journal_(NULL),
+    numReplayedSplits_(0),
+    journalMismatch_(false)
 {
 }
 
 Master::~Master() {
     LOG(INFO) << " numSplitRequests_: " << numSplitRequests_ <<
                  " numSplitResponses_: " << numSplitResponses_ <<
+                 " numBatchRequests_: " << numBatchRequests_ <<
+                 " numBatchResponses_: " << numBatchResponses_ <<
                  " numHeartBeatRequests_: " << numHeartBeatRequests_ <<
                  " numHeartBeatResponses_: " << numHeartBeatResponses_ <<
-                 " numRegistrations_: " << numRegistrations_;
+                 " numHeartBeatsSkipped_: " << numHeartBeatsSkipped_ <<
+                 " numRegistrations_: " << numRegistrations_ <<
+                 " numBackupRequests_: " << numBackupRequests_ <<
+                 " numBackupWins_: " << numBackupWins_ <<
+                 " numRetries_: " << numRetries_ <<
+                 " numReplayedSplits_: " << numReplayedSplits_;
+    delete scheduler_;
+    delete source_;
+    delete journal_;
 }
 
 void Master::onResponse(const FullRequest& response) {
     AnyRequest_Type type = response.protoMessage.type();
 
+    // whatever it sent, this worker is alive. @see onHeartBeatTimeout
+    WorkerId from = workerId(response.worker);
+    if(from != kNoWorker) {
+        workerInfo_[from].lastHeardMillis = timers_.now();
+    }
 
     if(type == AnyRequest_Type_HEARTBEAT_RESPONSE) {
-        // this worker is alive, save time
-        heartBeatTimeoutTick_[response.worker] = boost::posix_time::microsec_clock::local_time();
         LOG(INFO) << "received heartbeat response from " << response.worker;
         ++numHeartBeatResponses_;
     }
     else if(type == AnyRequest_Type_REGISTRATION) {
-        std::string id = response.protoMessage.registration().id();
-        LOG(INFO) << "received registration from worker " << response.worker << " identified as " << id;
+        const Registration& registration = response.protoMessage.registration();
+        const std::string& id = registration.id();
+        uint32_t credits = registration.has_credits() ? registration.credits() : kDefaultWorkerCredits_;
+        LOG(INFO) << "received registration from worker " << response.worker << " identified as " << id <<
+                     " with " << credits << " credits";
         ++numRegistrations_;
+        if(workerIndex_.find(response.worker) != workerIndex_.end()) {
+            // restarted before its heartbeats timed out. Whatever it was running is lost
+            LOG(INFO) << "worker " << response.worker << " registered again, rescheduling its splits";
+            dropWorker(response.worker);
+        }
         // add to registered workers list
-        workers_.push_back(response.worker);
+        if(workerIndex_.find(response.worker) == workerIndex_.end()) {
+            workerIndex_[response.worker] = workers_.size();
+            workers_.push_back(response.worker);
+        }
+        std::map<std::string, WorkerId>::iterator known = workerIds_.find(response.worker);
+        if(known == workerIds_.end()) {
+            workerIds_[response.worker] = workerInfo_.size();
+            workerInfo_.push_back(WorkerInfo(response.worker));
+        }
+        else {
+            // a worker that comes back gets a clean record
+            WorkerInfo& info = workerInfo_[known->second];
+            info.ok = 0;
+            info.failed = 0;
+            info.blacklisted = false;
+            info.batchesSentMillis.clear();
+        }
+        workerInfo_[workerIds_[response.worker]].lastHeardMillis = timers_.now();
+        workerInfo_[workerIds_[response.worker]].credits = credits;
+        scheduler_->addWorker(response.worker, credits);
         //initialize timers
-        heartBeatTimeoutTick_[response.worker] = boost::posix_time::microsec_clock::local_time();
+        resetHeartBeatTimeout(response.worker);
     }
     else if(type == AnyRequest_Type_FETCH_SPLIT_RESPONSE) {
         // update timer
-        lackOfProgressTick_ = boost::posix_time::microsec_clock::local_time();
-        LOG(INFO) << "received splitresponse for " << response.protoMessage.fetchsplitresponse().filename() << " from worker " << response.worker;
-        std::string splitId = response.protoMessage.fetchsplitresponse().filename();
-        SplitMapIt it = requestsInFlight_.find(splitId);
-        if(it != requestsInFlight_.end()) {
-            SplitTrackingInfo &s = it->second;
-            if(s.status == Status::PENDING) {
-                --responsesLeft_;
-                ++numSplitResponses_;
-                //TODO handle if the status is ERROR e.g. rescheduling to another worker
-                if (response.protoMessage.fetchsplitresponse().status() == 0) s.status = Status::OK;
-                else s.status = Status::ERROR;
+        resetLackOfProgressTimeout();
+        ++numBatchResponses_;
+        bool running = onSplitResponse(response.worker, response.protoMessage.fetchsplitresponse());
+        WorkerId worker = workerId(response.worker);
+        if((worker != kNoWorker) && running) {
+            recordBatchTime(worker, 1);
+        }
+    }
+    else if(type == AnyRequest_Type_FETCH_SPLIT_BATCH_RESPONSE) {
+        resetLackOfProgressTimeout();
+        ++numBatchResponses_;
+        const FetchSplitBatchResponse& batch = response.protoMessage.fetchsplitbatchresponse();
+        LOG(INFO) << "received batch of " << batch.splits_size() << " split responses from worker " << response.worker;
+        // a batch sent before the worker registered again has no entry in batchesSentMillis
+        bool running = false;
+        for(int i = 0; i < batch.splits_size(); i++) {
+            running |= onSplitResponse(response.worker, batch.splits(i));
+        }
+        // the worker may take more or fewer splits from now on
+        WorkerId worker = workerId(response.worker);
+        if(batch.has_credits()) {
+            scheduler_->setCredits(response.worker, batch.credits());
+            if(worker != kNoWorker) {
+                workerInfo_[worker].credits = batch.credits();
+            }
+        }
+        if((worker != kNoWorker) && running) {
+            recordBatchTime(worker, batch.splits_size());
+        }
+    }
+}
+
+bool Master::onSplitResponse(const std::string& workerName, const FetchSplitResponse& response) {
+    LOG(INFO) << "received splitresponse for split " << response.id() << " from worker " << workerName;
+    WorkerId worker = workerId(workerName);
+    if(worker == kNoWorker) {
+        LOG(ERROR) << "received response for split " << response.id() << " from unknown worker " << workerName;
+        return false;
+    }
+    std::multiset<SplitId>& pending = workerInfo_[worker].pendingSplits;
+    std::multiset<SplitId>::iterator sent = pending.find(response.id());
+    if(sent == pending.end()) {
+        // sent before the worker died or registered again, the split was rescheduled then
+        LOG(INFO) << "ignoring response for split " << response.id() << " from worker " << workerName << ", that copy is no longer in flight";
+        return false;
+    }
+    // the worker was busy with the copy whatever happened to the split since
+    pending.erase(sent);
+    scheduler_->onSplitDone(workerName);
+    SplitTrackingInfo* split = findSplit(response.id());
+    if((split == NULL) || (split->status != Status::PENDING) || !attempts_.running(*split, worker)) {
+        // a copy that was given up on: it missed its deadline or the other copy won.
+        // Only the copies still running decide the split's status
+        LOG(INFO) << "ignoring response for split " << response.id() << " from worker " << workerName << ", that copy was given up on";
+        return true;
+    }
+    SplitTrackingInfo &s = *split;
+    bool fromBackup = (worker == s.backupWorker);
+    bool failed = response.status() != 0;
+    --s.copiesInFlight;
+    attempts_.done(s, worker, failed ? Status::ERROR : Status::OK);
+    recordWorkerResult(worker, failed);
+    if(failed) {
+        onSplitFailed(s, fromBackup);
+    }
+    else {
+        --responsesLeft_;
+        ++numSplitResponses_;
+        timers_.cancel(s.deadlineTimer);
+        recordSplitDuration(timers_.now() - s.sentMillis);
+        if(s.backupWorker != kNoWorker) {
+            // first copy to answer wins. The other one is given up on, so a straggler doesn't keep the split in the window
+            --s.copiesInFlight;
+            --numBackupsInFlight_;
+            if(fromBackup) {
+                LOG(INFO) << "backup of split " << s.id << " on worker " << workerName << " won";
+                ++numBackupWins_;
+            }
+        }
+        s.status = Status::OK;
+        if(journal_ != NULL) {
+            journal_->append(s.id, JournalRecordType::OK);
+        }
+    }
+    return true;
+}
+
+
+void Master::onSplitFailed(SplitTrackingInfo& s, bool fromBackup) {
+    if(s.backupWorker != kNoWorker) {
+        // the other copy is still running, let it finish
+        LOG(INFO) << "split " << s.id << " failed on worker " << workerName(fromBackup ? s.backupWorker : s.worker) <<
+                     ", waiting for the copy on worker " << workerName(fromBackup ? s.worker : s.backupWorker);
+        if(!fromBackup) {
+            s.worker = s.backupWorker;
+        }
+        s.backupWorker = kNoWorker;
+        --numBackupsInFlight_;
+        return;
+    }
+    timers_.cancel(s.deadlineTimer);
+    uint32_t failures = attempts_.numFailures(s);
+    if(failures >= kMaxSplitAttempts_) {
+        LOG(ERROR) << "split " << s.id << " failed " << failures << " times, giving up";
+        --responsesLeft_;
+        ++numSplitResponses_;
+        s.status = Status::ERROR;
+        if(journal_ != NULL) {
+            journal_->append(s.id, JournalRecordType::ERROR);
+        }
+        return;
+    }
+    // exponential backoff, the worker may just be overloaded
+    uint64_t backoff = kRetryBackoffMillis_ << std::min(failures - 1, 32u);
+    if(backoff > kMaxRetryBackoffMillis_) {
+        backoff = kMaxRetryBackoffMillis_;
+    }
+    LOG(INFO) << "split " << s.id << " failed on worker " << workerName(s.worker) << ", retrying in " << backoff << "ms";
+    // not running anywhere until the retry is sent
+    s.worker = kNoWorker;
+    ++numRetries_;
+    timers_.schedule(backoff, boost::bind(&Master::onRetryTimer, this, s.id));
+}
+
+void Master::onRetryTimer(SplitId split) {
+    // retries go before the splits that haven't been tried yet
+    requests_.push_front(split);
+}
+
+void Master::recordWorkerResult(WorkerId worker, bool failed) {
+    WorkerInfo& info = workerInfo_[worker];
+    if(failed) {
+        ++info.failed;
+    }
+    else {
+        ++info.ok;
+    }
+    uint64_t total = info.ok + info.failed;
+    if(!info.blacklisted && failed && (total >= kBlacklistMinSplits_) &&
+            (info.failed > total * kBlacklistFailureRate_) && (scheduler_->numWorkers() > 1)) {
+        // keep it registered (and heartbeating) so its running splits can finish, but send it nothing new
+        LOG(ERROR) << "blacklisting worker " << info.name << ": " << info.failed << " out of " << total << " splits failed";
+        info.blacklisted = true;
+        scheduler_->removeWorker(info.name);
+    }
+}
+
+WorkerId Master::workerId(const std::string& worker) const {
+    std::map<std::string, WorkerId>::const_iterator it = workerIds_.find(worker);
+    return (it == workerIds_.end()) ? kNoWorker : it->second;
+}
+
+const std::string& Master::workerName(WorkerId worker) const {
+    static const std::string none("none");
+    return (worker == kNoWorker) ? none : workerInfo_[worker].name;
+}
+
+void Master::fillSplitRequest(SplitId split, FetchSplitRequest* request) const {
+    request->set_id(split);
+    // the only copy of the name until Transport serializes it
+    if(source_->hasNames()) {
+        request->set_filename(splitNames_[split - firstSplit_]);
+    }
+}
+
+void Master::pullSplits(size_t n) {
+    std::string name;
+    while((requests_.size() < n) && !sourceDone_) {
+        if(!source_->next(&name)) {
+            LOG(INFO) << "no more splits, " << firstSplit_ + splits_.size() << " in total";
+            sourceDone_ = true;
+            if((journal_ != NULL) && (firstSplit_ + splits_.size() < journal_->watermark())) {
+                LOG(ERROR) << "the journal has more splits done than there are";
+                journalMismatch_ = true;
+            }
+            break;
+        }
+        SplitId id = firstSplit_ + splits_.size();
+        Status::value replayed = Status::PENDING;
+        if((journal_ != NULL) && !journal_->replayedStatus(id, name, &replayed)) {
+            journalMismatch_ = true;
+            break;
+        }
+        if(replayed != Status::PENDING) {
+            ++numReplayedSplits_;
+        }
+        if((replayed != Status::PENDING) && splits_.empty()) {
+            // nothing before it in the window, no need to track it
+            ++firstSplit_;
+            if(replayed == Status::OK) {
+                ++numOkSplits_;
             }
             else {
-                LOG(ERROR) << "received response for split " << s.id << " that wasn't pending. its status was " << s.status;
+                ++numErrorSplits_;
             }
-         }
-         else {
-             LOG(ERROR) << "received unknown response for split" << splitId << " from worker " << response.worker;
-         }
+            continue;
+        }
+        splits_.push_back(SplitTrackingInfo());
+        splits_.back().id = id;
+        splits_.back().status = replayed;
+        if(source_->hasNames()) {
+            splitNames_.push_back(std::string());
+            splitNames_.back().swap(name);
+        }
+        if(replayed == Status::PENDING) {
+            requests_.push_back(id);
+            ++responsesLeft_;
+        }
     }
 }
 
+SplitTrackingInfo* Master::findSplit(SplitId split) {
+    if((split < firstSplit_) || (split - firstSplit_ >= splits_.size())) {
+        return NULL;
+    }
+    return &splits_[split - firstSplit_];
+}
+
+bool Master::waitingToBeSent(SplitId split) {
+    const SplitTrackingInfo* s = findSplit(split);
+    return (s != NULL) && (s->status == Status::PENDING);
+}
+
+void Master::dropStaleRequests(size_t n) {
+    // ids are only queued while their split has no copy in flight, so this should never find any
+    size_t kept = 0;
+    n = std::min(n, requests_.size());
+    for(size_t i = 0; i < n; i++) {
+        if(waitingToBeSent(requests_[i])) {
+            requests_[kept++] = requests_[i];
+        }
+        else {
+            LOG(ERROR) << "dropping split " << requests_[i] << " from the send queue, it's done or unknown";
+        }
+    }
+    requests_.erase(requests_.begin() + kept, requests_.begin() + n);
+}
+
+void Master::retireSplits() {
+    while(!splits_.empty() && (splits_.front().status != Status::PENDING) && (splits_.front().copiesInFlight == 0)) {
+        if(splits_.front().status == Status::OK) {
+            ++numOkSplits_;
+        }
+        else {
+            LOG(ERROR) << "error on split " << firstSplit_;
+            ++numErrorSplits_;
+        }
+        attempts_.erase(splits_.front());
+        splits_.pop_front();
+        if(source_->hasNames()) {
+            splitNames_.pop_front();
+        }
+        ++firstSplit_;
+    }
+    // speculation only trims it at the end of the job
+    while(!sendOrder_.empty() && (sendOrder_.front().second < firstSplit_)) {
+        sendOrder_.pop_front();
+    }
+}
 
 void Master::onWorkerDead(const std::string& worker) {
     LOG(INFO) << "worker " << worker << " is dead";
+    dropWorker(worker);
+    if(scheduler_->numWorkers() == 0) {
+        reinstateBlacklistedWorker();
+    }
+}
 
+void Master::dropWorker(const std::string& worker) {
     //remove inflight reqs from dead worker
-    for(SplitMapIt it = requestsInFlight_.begin(); it != requestsInFlight_.end(); it++) {
-        //std::string& splitId = it->first;
-        SplitTrackingInfo &s = it->second;
-        if((s.worker == worker) && (s.status == Status::PENDING)) {
-            //reschedule split
-            LOG(INFO) << "rescheduling split " << s.id;
-            requests_.push_back(SplitTrackingInfo(s.id));
-        }
-        else if((s.worker == worker) && (s.status != Status::PENDING)) {
-            //in this case maybe the worker send the response before dying
-            LOG(INFO) << "trying to mark split " << s.id << " but it's not pending it's " << s.status;
+    WorkerId id = workerId(worker);
+    if(id != kNoWorker) {
+        std::multiset<SplitId>& pending = workerInfo_[id].pendingSplits;
+        // a split given up on and sent to the worker again is in pending twice, it's handled once
+        for(std::multiset<SplitId>::const_iterator split = pending.begin(); split != pending.end();
+                split = pending.upper_bound(*split)) {
+            SplitTrackingInfo* tracked = findSplit(*split);
+            if((tracked == NULL) || (tracked->status != Status::PENDING) || !attempts_.running(*tracked, id)) {
+                // the copy was given up on already
+                continue;
+            }
+            SplitTrackingInfo &s = *tracked;
+            --s.copiesInFlight;
+            if(s.backupWorker == id) {
+                // the original copy is still running
+                s.backupWorker = kNoWorker;
+                --numBackupsInFlight_;
+            }
+            else if(s.backupWorker != kNoWorker) {
+                // no need to reschedule, the backup takes over
+                LOG(INFO) << "backup of split " << s.id << " on worker " << workerName(s.backupWorker) << " takes over";
+                s.worker = s.backupWorker;
+                s.backupWorker = kNoWorker;
+                --numBackupsInFlight_;
+            }
+            else {
+                //reschedule split
+                LOG(INFO) << "rescheduling split " << s.id;
+                timers_.cancel(s.deadlineTimer);
+                s.worker = kNoWorker;
+                requests_.push_back(s.id);
+            }
         }
+        pending.clear();
+        workerInfo_[id].batchesSentMillis.clear();
     }
 
     // remove worker from list
     // important to do after the checks above
-    for(int i = 0; i < workers_.size(); i++) {
-        if(workers_[i] == worker) {
-            workers_.erase(workers_.begin() + i);
+    std::map<std::string, size_t>::iterator index = workerIndex_.find(worker);
+    if(index != workerIndex_.end()) {
+        // fill the hole with the last worker
+        size_t i = index->second;
+        workerIndex_.erase(index);
+        if(i != workers_.size() - 1) {
+            workers_[i] = workers_.back();
+            workerIndex_[workers_[i]] = i;
+        }
+        workers_.pop_back();
+    }
+    scheduler_->removeWorker(worker);
+}
+
+void Master::reinstateBlacklistedWorker() {
+    for(size_t i = 0; i < workers_.size(); i++) {
+        WorkerInfo& info = workerInfo_[workerId(workers_[i])];
+        if(info.blacklisted) {
+            // a worker that fails some splits beats no worker at all. Blacklisting needs another worker,
+            // so it stays until one registers
+            LOG(ERROR) << "no other worker left, taking blacklisted worker " << info.name << " back";
+            info.blacklisted = false;
+            info.ok = 0;
+            info.failed = 0;
+            scheduler_->addWorker(info.name, info.credits);
+            return;
+        }
+    }
+}
+
+void Master::resetHeartBeatTimeout(const std::string& worker) {
+    base::TimerWheel::TimerId& timer = heartBeatTimeoutTimers_[worker];
+    timers_.cancel(timer);
+    timer = timers_.schedule(kHeartBeatTimeout_, boost::bind(&Master::onHeartBeatTimeout, this, worker));
+}
+
+void Master::onHeartBeatTimeout(const std::string& worker) {
+    WorkerId id = workerId(worker);
+    uint64_t quietMillis = (id == kNoWorker) ? kHeartBeatTimeout_ : timers_.now() - workerInfo_[id].lastHeardMillis;
+    if(quietMillis < kHeartBeatTimeout_) {
+        heartBeatTimeoutTimers_[worker] = timers_.schedule(kHeartBeatTimeout_ - quietMillis,
+                                                           boost::bind(&Master::onHeartBeatTimeout, this, worker));
+        return;
+    }
+    heartBeatTimeoutTimers_.erase(worker);
+    onWorkerDead(worker);
+}
+
+void Master::resetLackOfProgressTimeout() {
+    timers_.cancel(lackOfProgressTimer_);
+    lackOfProgressTimer_ = timers_.schedule(kLackOfProgressTimeout_, boost::bind(&Master::onLackOfProgress, this));
+}
+
+void Master::onLackOfProgress() {
+    lackOfProgress_ = true;
+}
+
+void Master::onSplitDeadline(SplitId split) {
+    SplitTrackingInfo* s = findSplit(split);
+    if((s == NULL) || (s->status != Status::PENDING) || (s->worker == kNoWorker)) {
+        return;
+    }
+    // the worker is alive, it would have been dropped otherwise. Give up on the copy like on a failed one,
+    // a split stuck on it would keep every split after it in the window.
+    // The worker keeps the credit until it answers, and the answer is ignored
+    WorkerId worker = s->worker;
+    LOG(ERROR) << "split " << split << " still pending on worker " << workerName(worker) <<
+                  " after " << kSplitDeadline_ << "ms, giving up on that copy";
+    --s->copiesInFlight;
+    attempts_.done(*s, worker, Status::ERROR);
+    recordWorkerResult(worker, true);
+    onSplitFailed(*s, false);
+    if((s->status == Status::PENDING) && (s->worker != kNoWorker)) {
+        // the backup took over, it gets a deadline of its own
+        s->deadlineTimer = timers_.schedule(kSplitDeadline_, boost::bind(&Master::onSplitDeadline, this, s->id));
+    }
+}
+
+void Master::setSpeculationOptions(const SpeculationOptions& options) {
+    speculation_ = options;
+}
+
+void Master::setJournal(const std::string& path) {
+    delete journal_;
+    journal_ = new SplitJournal(path);
+}
+
+void Master::onJournalTimer() {
+    timers_.schedule(kJournalSyncFrequency_, boost::bind(&Master::onJournalTimer, this));
+    journal_->sync();
+    if(journal_->bytes() > kJournalCompactionBytes_) {
+        compactJournal();
+    }
+}
+
+void Master::compactJournal() {
+    // everything before the window is done, the journal keeps the records of the ones that failed
+    std::vector<std::pair<SplitId, Status::value> > done;
+    for(size_t i = 0; i < splits_.size(); i++) {
+        if(splits_[i].status != Status::PENDING) {
+            done.push_back(std::make_pair(splits_[i].id, splits_[i].status));
+        }
+    }
+    journal_->compact(firstSplit_, done);
+}
+
+
+void Master::recordSplitDuration(uint64_t millis) {
+    if(splitDurations_.size() < kSplitDurationSamples_) {
+        splitDurations_.push_back(millis);
+    }
+    else {
+        splitDurations_[numSplitResponses_ % kSplitDurationSamples_] = millis;
+    }
+}
+
+void Master::onSpeculationTimer() {
+    timers_.schedule(kSpeculationCheckFrequency_, boost::bind(&Master::onSpeculationTimer, this));
+    // only once every split has been sent, before that idle workers get new splits anyway
+    if(!speculation_.enabled || !sourceDone_ || !requests_.empty() || (splitDurations_.size() < speculation_.minSamples)) {
+        return;
+    }
+    std::vector<uint64_t> durations(splitDurations_);
+    std::nth_element(durations.begin(), durations.begin() + durations.size() / 2, durations.end());
+    uint64_t threshold = durations[durations.size() / 2] * speculation_.slownessFactor;
+
+    // oldest first. Splits that are done (or were sent again) are dropped from the front as we go
+    for(std::deque<std::pair<uint64_t, SplitId> >::iterator it = sendOrder_.begin();
+            (it != sendOrder_.end()) && (numBackupsInFlight_ < speculation_.maxBackups); ) {
+        if(timers_.now() - it->first <= threshold) {
+            break;  // the rest are younger
+        }
+        SplitTrackingInfo* split = findSplit(it->second);
+        // no worker means the split is waiting to be sent again
+        if((split == NULL) || (split->status != Status::PENDING) || (split->sentMillis != it->first) ||
+                (split->worker == kNoWorker)) {
+            if(it == sendOrder_.begin()) {
+                sendOrder_.pop_front();
+                it = sendOrder_.begin();
+            }
+            else {
+                ++it;
+            }
+            continue;
+        }
+        if((split->backupWorker == kNoWorker) && !sendBackup(*split)) {
+            break;  // no idle worker or no room in the queue, try again later
+        }
+        ++it;
+    }
+}
+
+void Master::sendBatch(base::Block<FullRequest>* block, size_t maxSplits) {
+    // run() dropped the ids that aren't waiting to be sent before taking the slot
+    SplitTrackingInfo* s = findSplit(requests_.front());
+    // retries go to a worker the split hasn't failed on if there is one
+    std::vector<std::string> avoid;
+    failedWorkerNames(*s, &avoid);
+    AnyRequest& req = block->data.emplace(AnyRequest_Type_FETCH_SPLIT_BATCH_REQUEST,
+                                          scheduler_->chooseWorkerAvoiding(avoid));
+    const std::string& name = block->data.worker;
+    WorkerId worker = workerId(name);
+    FetchSplitBatchRequest* batch = req.mutable_fetchsplitbatchrequest();
+    // the scheduler only picks workers with free credits
+    int numSplits = std::min<uint64_t>(std::min<size_t>(batchSize(worker), maxSplits), scheduler_->freeCredits(name));
+    uint64_t now = timers_.now();
+    while(true) {
+        scheduler_->onSplitSent(name);
+        fillSplitRequest(s->id, batch->add_splits());
+        if(journal_ != NULL) {
+            journal_->append(s->id, JournalRecordType::DISPATCHED);
+        }
+        s->worker = worker;
+        s->sentMillis = now;
+        attempts_.add(*s, worker, now);
+        ++s->copiesInFlight;
+        workerInfo_[worker].pendingSplits.insert(s->id);
+        sendOrder_.push_back(std::make_pair(now, s->id));
+        timers_.cancel(s->deadlineTimer);
+        s->deadlineTimer = timers_.schedule(kSplitDeadline_, boost::bind(&Master::onSplitDeadline, this, s->id));
+        LOG(INFO) << "sending split " << s->id << " to worker " << name;
+        ++numSplitRequests_;
+        requests_.pop_front();
+        dropStaleRequests(1);
+
+        if((batch->splits_size() == numSplits) || requests_.empty()) {
+            break;
+        }
+        s = findSplit(requests_.front());
+        // the next one waits for a worker it hasn't failed on
+        if(attempts_.failedOn(*s, worker)) {
             break;
         }
     }
+    workerInfo_[worker].batchesSentMillis.push_back(now);
+    ++numBatchRequests_;
+}
+
+uint32_t Master::batchSize(WorkerId worker) const {
+    double millisPerSplit = workerInfo_[worker].millisPerSplit;
+    if(millisPerSplit < 0) {
+        return 1;
+    }
+    if(millisPerSplit * kMaxSplitsPerBatch_ <= kTargetBatchMillis_) {
+        return kMaxSplitsPerBatch_;
+    }
+    return std::max<uint32_t>(1, kTargetBatchMillis_ / millisPerSplit);
+}
+
+void Master::recordBatchTime(WorkerId worker, uint32_t numSplits) {
+    WorkerInfo& info = workerInfo_[worker];
+    uint64_t now = timers_.now();
+    if(!info.batchesSentMillis.empty() && (numSplits > 0)) {
+        // the worker started on this batch when it was done with the one before, or when it got it
+        uint64_t started = std::max(info.batchesSentMillis.front(), info.lastResponseMillis);
+        double millisPerSplit = static_cast<double>(now - started) / numSplits;
+        if(info.millisPerSplit < 0) {
+            info.millisPerSplit = millisPerSplit;
+        }
+        else {
+            info.millisPerSplit = 0.75 * info.millisPerSplit + 0.25 * millisPerSplit;
+        }
+        info.batchesSentMillis.pop_front();
+        // a busy worker gets its next batch once it has room for all of it
+        scheduler_->setMinFreeCredits(info.name, batchSize(worker));
+    }
+    info.lastResponseMillis = now;
+}
+
+void Master::failedWorkerNames(const SplitTrackingInfo& s, std::vector<std::string>* names) const {
+    if((s.firstAttempt.status == Status::ERROR) || s.retried) {
+        std::vector<WorkerId> failed;
+        attempts_.failedWorkers(s, &failed);
+        for(size_t i = 0; i < failed.size(); i++) {
+            names->push_back(workerName(failed[i]));
+        }
+    }
+}
+
+bool Master::sendBackup(SplitTrackingInfo& s) {
+    // not the worker running it, nor one it failed on
+    std::vector<std::string> avoid(1, workerName(s.worker));
+    failedWorkerNames(s, &avoid);
+    const std::string* idle = scheduler_->idleWorker(avoid);
+    if(idle == NULL) {
+        return false;
+    }
+    base::Block<FullRequest> *backup;
+    if(!requestQueue_->tryGetWriteSlot(&backup)) {
+        return false;
+    }
+    AnyRequest& req = backup->data.emplace(AnyRequest_Type_FETCH_SPLIT_BATCH_REQUEST, *idle);
+    // idle points into the scheduler, which moves workers around as they run out of credits
+    const std::string& worker = backup->data.worker;
+    fillSplitRequest(s.id, req.mutable_fetchsplitbatchrequest()->add_splits());
+    if(journal_ != NULL) {
+        journal_->append(s.id, JournalRecordType::DISPATCHED);
+    }
+    LOG(INFO) << "split " << s.id << " is slow on worker " << workerName(s.worker) << ", sending a backup to worker " << worker;
+    s.backupWorker = workerId(worker);
+    attempts_.add(s, s.backupWorker, timers_.now());
+    ++s.copiesInFlight;
+    workerInfo_[s.backupWorker].pendingSplits.insert(s.id);
+    workerInfo_[s.backupWorker].batchesSentMillis.push_back(timers_.now());
+    scheduler_->onSplitSent(worker);
+    requestQueue_->slotWritten(backup);
+    ++numBatchRequests_;
+    ++numBackupsInFlight_;
+    ++numBackupRequests_;
+    return true;
+}
+
+void Master::onHeartBeatSendTimer() {
+    base::Block<FullRequest> *heartBeatRequest;
+    for(int i = 0; i < workers_.size(); i++) {
+        const std::string& worker = workers_[heartBeatIndex_++ % workers_.size()];
+        // workers busy sending us responses don't need one
+        WorkerId id = workerId(worker);
+        if((id != kNoWorker) && (timers_.now() - workerInfo_[id].lastHeardMillis < kHeartBeatQuietMillis_)) {
+            ++numHeartBeatsSkipped_;
+            continue;
+        }
+        while(1) {
+            //try until we send heartbeats for all the quiet workers
+            if(controlQueue_->tryGetWriteSlot(&heartBeatRequest)) {
+                //send hearbeat and reset
+                heartBeatRequest->data.emplace(AnyRequest_Type_HEARTBEAT_REQUEST, worker).mutable_heartbeatrequest();
+                LOG(INFO) << "sending heartbeat to worker " << heartBeatRequest->data.worker;
+                controlQueue_->slotWritten(heartBeatRequest);
+                ++numHeartBeatRequests_;
+                break;
+            } // if
+        }  // while(1)
+    }  // for every worker
+    timers_.schedule(kHeartBeatSendFrequency_, boost::bind(&Master::onHeartBeatSendTimer, this));
 }
 
-std::string Master::getRoundRobinWorker() {
+void Master::onQueueStatsTimer() {
+    LOG(INFO) << "requestQueue: " << requestQueue_->stats().toString();
+    LOG(INFO) << "controlQueue: " << controlQueue_->stats().toString();
+    LOG(INFO) << "responseQueue: " << responseQueue_->stats().toString();
+    timers_.schedule(kQueueStatsLogFrequency_, boost::bind(&Master::onQueueStatsTimer, this));
+}
+
+void Master::onQueueResizeTimer() {
+    resizeQueues(timers_.now() - lastQueueResizeMillis_);
+    lastQueueResizeMillis_ = timers_.now();
+    timers_.schedule(kQueueResizeFrequency_, boost::bind(&Master::onQueueResizeTimer, this));
+}
 
-    std::string chosen =  workers_[index_ % workers_.size()];
-    ++index_;
-    return chosen;
+void Master::resizeQueues(uint64_t elapsedMillis) {
+    // batches per second the workers got through since the last call.
+    // The queues hold batches, however many splits they carry
+    double drainRate = (numBatchResponses_ - lastNumBatchResponses_) * 1000.0 / elapsedMillis;
+    lastNumBatchResponses_ = numBatchResponses_;
+
+    // Little's law: depth = rate x time
+    uint64_t capacity = std::max<uint64_t>(drainRate * kTargetQueueingMillisecs_ / 1000,
+                                           workers_.size() * kMinQueueDepthPerWorker_);
+    capacity = std::min(std::max(capacity, kMinQueueCapacity_), kMaxQueueCapacity_);
+
+    uint64_t current = requestQueue_->capacity();
+    if((capacity > current) || (capacity < current / 2)) {
+        LOG(INFO) << "resizing queues from " << current << " to " << capacity <<
+                     " drain rate: " << drainRate << " batches/s workers: " << workers_.size();
+        requestQueue_->resize(capacity);
+        responseQueue_->resize(capacity);
+    }
 }
 
 void Master::run()
 {
     LOG(INFO) << "starting master";
 
-    //initialize timers
-
-    //used to send heartbeats periodically
-    boost::posix_time::ptime heartBeatSendTick = boost::posix_time::microsec_clock::local_time();
-    for(int i = 0; i < workers_.size(); i++) {
-        //used to check for dead workers
-        heartBeatTimeoutTick_[workers_[i]] = boost::posix_time::microsec_clock::local_time();
+    // replay before pulling any split
+    if((journal_ != NULL) && !journal_->open()) {
+        LOG(ERROR) << "can't use the journal, exiting ...";
+        return;
     }
 
+    //initialize timers
+    timers_.advance(base::TimerWheel::nowMillis());
+    //used to send heartbeats periodically
+    timers_.schedule(kHeartBeatSendFrequency_, boost::bind(&Master::onHeartBeatSendTimer, this));
     //handle lack of progress
-    lackOfProgressTick_ = boost::posix_time::microsec_clock::local_time();
-
-    //create the request list
-    for(int i = 0; i < requestsLeft_; i++) {
-        std::string filename = (boost::format("split%d") %(i)).str();
-        requests_.push_back(SplitTrackingInfo(filename));
+    resetLackOfProgressTimeout();
+    //used to log queue stats periodically
+    timers_.schedule(kQueueStatsLogFrequency_, boost::bind(&Master::onQueueStatsTimer, this));
+    //used to resize the queues periodically
+    lastQueueResizeMillis_ = timers_.now();
+    timers_.schedule(kQueueResizeFrequency_, boost::bind(&Master::onQueueResizeTimer, this));
+    //used to send backups of slow splits
+    timers_.schedule(kSpeculationCheckFrequency_, boost::bind(&Master::onSpeculationTimer, this));
+    //used to write the journal in batches
+    if(journal_ != NULL) {
+        timers_.schedule(kJournalSyncFrequency_, boost::bind(&Master::onJournalTimer, this));
     }
 
+    // sleep until there are responses, there is room for split requests or a timer is due
+    struct pollfd fds[2];
+    fds[0].fd = responseQueue_->readFd();
+    fds[0].events = POLLIN;
+    fds[1].fd = requestQueue_->writeFd();
+    fds[1].events = POLLIN;
 
     // TODO if we insert to many splitFetchRequests in between heartbeats
     // we cannot guarantee hearbeats are sent exactly every kHeartBeatSendFrequency_
 
-    while((requests_.size() > 0) ||
+    while(!sourceDone_ || (requests_.size() > 0) ||
           (responsesLeft_ > 0)) {
 
-        // tick
-        boost::posix_time::ptime now  = boost::posix_time::microsec_clock::local_time();
+        // run the timers that are due: heartbeats, timeouts, stats and queue resizing
+        timers_.advance(base::TimerWheel::nowMillis());
 
         // check for lack of progress
-        boost::posix_time::time_duration lackOfProgressDiff = now - lackOfProgressTick_;
-        if(lackOfProgressDiff.total_milliseconds() > kLackOfProgressTimeout_) {
+        if(lackOfProgress_) {
             LOG(ERROR) << "lack of progress, exiting ...";
             goto end;
         }
 
         /**
-         * Send heartbeat requests
+         * wait for the next event
          */
-        boost::posix_time::time_duration heartBeatSendDiff = now - heartBeatSendTick;
-        uint64_t tmp = heartBeatSendDiff.total_milliseconds();
-
-        if(tmp > kHeartBeatSendFrequency_) {
-            base::Block<FullRequest> *heartBeatRequest;
-            for(int i = 0; i < workers_.size(); i++) {
-                while(1) {
-                    //try until we send heartbeats for all the workers
-                    if(requestQueue_->tryGetWriteSlot(&heartBeatRequest)) {
-                        //send hearbeat and reset
-                        AnyRequest req;
-                        req.set_type(AnyRequest_Type_HEARTBEAT_REQUEST);
-                        HeartBeatRequest *r = new HeartBeatRequest;
-                        req.set_allocated_heartbeatrequest(r);
-                        heartBeatRequest->data.protoMessage = req;
-
-                        heartBeatRequest->data.worker = workers_[heartBeatIndex_ % workers_.size()];
-                        LOG(INFO) << "sending heartbeat to worker " << heartBeatRequest->data.worker;
-                        ++heartBeatIndex_;
-                        requestQueue_->slotWritten(heartBeatRequest);
-                        heartBeatSendTick = boost::posix_time::microsec_clock::local_time();
-                        ++numHeartBeatRequests_;
-                        break;
-                    } // if
-                }  // while(1)
-            }  // for every worker
-        } // if
-
-        /**
-         * Check Heartbeats
-         */
-        for(int i = 0; i < workers_.size(); i++) {
-            boost::posix_time::time_duration heartBeatTimeoutDiff = now - heartBeatTimeoutTick_[workers_[i]];
-            if(heartBeatTimeoutDiff.total_milliseconds() > kHeartBeatTimeout_) {
-                onWorkerDead(workers_[i]);
-            }
+        int timeout = std::min<uint64_t>(timers_.ticksToNextTimer(), kHeartBeatSendFrequency_);
+        // splits are pulled as they are needed, one burst of full batches ahead
+        pullSplits(kSplitRequestBurst_ * kMaxSplitsPerBatch_);
+        if(journalMismatch_) {
+            LOG(ERROR) << "the splits don't match the journal, exiting ...";
+            goto end;
+        }
+        // only wake up for free slots if there is something to send and a worker to take it.
+        // Blacklisted workers are registered but can't get splits, workers out of credits have to answer first
+        bool canSend = (requests_.size() > 0) && (scheduler_->numAvailableWorkers() > 0);
+        fds[1].events = canSend ? POLLIN : 0;
+        if(poll(fds, 2, timeout) < 0 && errno != EINTR) {
+            LOG(ERROR) << "poll failed: " << strerror(errno);
         }
 
         /**
          * send next split requests
          */
         // while there are remaining splits and available workers send requests
-        if((requests_.size() > 0) && (workers_.size() > 0)) {
-            base::Block<FullRequest> *splitRequest;
-            if(requestQueue_->tryGetWriteSlot(&splitRequest)) {
-                SplitTrackingInfo& s = requests_.front();
-                AnyRequest req;
-                req.set_type(AnyRequest_Type_FETCH_SPLIT_REQUEST);
-                FetchSplitRequest *r = new FetchSplitRequest;
-                r->set_filename(s.id);
-                req.set_allocated_fetchsplitrequest(r);
-                splitRequest->data.protoMessage = req;
-                //TODO choose worker with the least splits outstanding instead of roundrobin
-                splitRequest->data.worker = getRoundRobinWorker();
-                requestsInFlight_.insert(
-                            std::pair<std::string,SplitTrackingInfo>(s.id, SplitTrackingInfo(s.id, splitRequest->data.worker)));
-                requestQueue_->slotWritten(splitRequest);
-                LOG(INFO) << "sending split " << s.id << " to worker " << splitRequest->data.worker;
-                ++numSplitRequests_;
-                requests_.pop_front();
+        if(canSend && (fds[1].revents & POLLIN)) {
+            // grab a burst of slots so the whole burst costs one lock and one notify.
+            // A slot holds a batch of splits
+            // a batch takes at least one split and makes at most its worker unavailable,
+            // so there is a split and a worker for every slot
+            dropStaleRequests(requests_.size());
+            uint32_t burst = std::min<uint64_t>(std::min(requests_.size(), scheduler_->numAvailableWorkers()),
+                                                kSplitRequestBurst_);
+            if(requestQueue_->tryGetWriteSlots(splitRequests_, burst) > 0) {
+                for(int i = 0; i < splitRequests_.size(); i++) {
+                    // leave at least one split for each of the slots after this one
+                    size_t slotsLeft = splitRequests_.size() - 1 - i;
+                    sendBatch(splitRequests_[i], requests_.size() - slotsLeft);
+                }
+                requestQueue_->slotsWritten(splitRequests_);
             }
         }
 
         /**
-         * receive next response
+         * receive all the responses that are ready
          */
-        base::Block<FullRequest> *response;
-        if(responseQueue_->tryGetReadSlot(&response)) {
-            onResponse(response->data);
-            responseQueue_->slotRead(response);
+        if(fds[0].revents & POLLIN) {
+            if(responseQueue_->tryGetReadSlots(responses_, kResponseBurst_) > 0) {
+                for(int i = 0; i < responses_.size(); i++) {
+                    onResponse(responses_[i]->data);
+                }
+                responseQueue_->slotsRead(responses_);
+            }
         }
-    }  // while((requests_.size() > 0) || (responsesLeft_ > 0))
+        retireSplits();
+    }  // while(!sourceDone_ || (requests_.size() > 0) || (responsesLeft_ > 0))
 
     /**
      * shutdown workers
@@ -232,14 +874,9 @@ void Master::run()
     for(int i = 0; i < workers_.size(); i++) {
         base::Block<FullRequest> *shutdown;
         while(1) {
-            if(requestQueue_->tryGetWriteSlot(&shutdown)) {
-                AnyRequest req;
-                req.set_type(AnyRequest_Type_SHUTDOWN_REQUEST);
-                ShutdownRequest *r = new ShutdownRequest;
-                req.set_allocated_shutdownrequest(r);
-                shutdown->data.protoMessage = req;
-                shutdown->data.worker = workers_[i];
-                requestQueue_->slotWritten(shutdown);
+            if(controlQueue_->tryGetWriteSlot(&shutdown)) {
+                shutdown->data.emplace(AnyRequest_Type_SHUTDOWN_REQUEST, workers_[i]).mutable_shutdownrequest();
+                controlQueue_->slotWritten(shutdown);
                 LOG(INFO) << "sent shutdown";
                 break;
             }
@@ -251,14 +888,26 @@ void Master::run()
     boost::this_thread::sleep(boost::posix_time::seconds(5));
 
 end:
-    uint64_t okSplits = 0;
+    if(journal_ != NULL) {
+        journal_->sync();
+    }
+    if(numReplayedSplits_ > 0) {
+        LOG(INFO) << numReplayedSplits_ << " splits were done by an earlier run";
+    }
+
+    // splits retired during the run were logged then
+    uint64_t okSplits = numOkSplits_;
 
     /**
      * check for errors
      */
 
-    for(SplitMapIt it = requestsInFlight_.begin(); it != requestsInFlight_.end(); it++) {
-        SplitTrackingInfo& s = it->second;
+    uint64_t sentSplits = numOkSplits_ + numErrorSplits_;
+    for(size_t i = 0; i < splits_.size(); i++) {
+        const SplitTrackingInfo& s = splits_[i];
+        if(s.firstAttempt.worker != kNoWorker) {
+            ++sentSplits;
+        }
         if(s.status == Status::ERROR) {
             LOG(ERROR) << "error on split " << s.id;
         }
@@ -270,7 +919,7 @@ end:
         }
     }
 
-    LOG(INFO) << "processed " << requestsInFlight_.size() << " splits";
+    LOG(INFO) << "processed " << sentSplits << " splits";
     LOG(INFO) << "ok: " << okSplits << " out of " << numSplitRequests_;
 }
 } // namespace distributor
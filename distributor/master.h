@@ -2,32 +2,93 @@
 #ifndef DDC_DISTRIBUTOR_MASTER_H
 #define DDC_DISTRIBUTOR_MASTER_H
 
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
 #include "base/producerconsumerqueue.h"
 #include "base/runnable.h"
+#include "base/timerwheel.h"
+#include "journal.h"
+#include "scheduler.h"
 #include "split.h"
+#include "splitsource.h"
 
 namespace ddc {
 namespace distributor {
 
+/**
+ * @brief Settings for speculative execution: once every split has been sent, splits that take much
+ * longer than usual get a backup copy on an idle worker. The first copy to answer wins.
+ */
+struct SpeculationOptions {
+    SpeculationOptions() :
+        enabled(true),
+        slownessFactor(3.0),
+        maxBackups(4),
+        minSamples(20)
+    {
+
+    }
+
+    bool enabled;
+    // a split is slow once it has been in flight for slownessFactor x the median split time
+    double slownessFactor;
+    // max number of backup copies in flight at the same time
+    uint32_t maxBackups;
+    // no backups until this many splits are done, to have a meaningful median
+    uint32_t minSamples;
+};
+
 /**
  * @brief The Master class
  *
  * The master class is responsible for sending a configurable number of requests to workers.
  * It does the following:
- * - Periodic heartbeat to check that workers are alive. @see kHeartBeatSendFrequency_ and kLackOfProgressTimeout_
+ * - Periodic heartbeat to check that workers are alive. Any message from a worker shows it is alive,
+ *   so only quiet workers get heartbeats. @see kHeartBeatSendFrequency_ and kLackOfProgressTimeout_
+ * - Pulls splits from a SplitSource as it has room to send them and sends every split to the worker
+ *   chosen by a Scheduler. @see SchedulerPolicy
+ * - Sends splits in batches sized after how fast each worker gets through them. @see kTargetBatchMillis_
+ * - Sends a worker no more splits than the credits it advertises, so a slow worker doesn't pile up
+ *   a backlog while the others wait. @see Scheduler
  * - If a worker is down it reschedules its splits to another worker.
+ * - Sends backup copies of slow splits at the end of the job. @see SpeculationOptions
+ * - Optionally journals split state so a restarted master skips the splits that are done. @see setJournal
  * - If there are no responses for a long time it times out and exits @see kLackOfProgressTimeout_
  *
+ * Heartbeats and shutdowns go through their own control queue so they never wait for space
+ * behind split requests.
+ *
+ * All the timing (heartbeats, timeouts, split deadlines, periodic jobs) is done with timers on
+ * a base::TimerWheel ticking in milliseconds, so nothing is scanned while no timer is due.
  */
 class Master: public base::Runnable  {
 public:
+    /**
+     * @param splits The splits of the job. Owned
+     */
     Master(base::ProducerConsumerQueue<base::Block<FullRequest> >* requestQueue,
+              base::ProducerConsumerQueue<base::Block<FullRequest> >* controlQueue,
               base::ProducerConsumerQueue<base::Block<FullRequest> >* responseQueue,
-              const uint64_t numRequests);
+              SplitSource* splits,
+              SchedulerPolicy::value schedulerPolicy = SchedulerPolicy::LEAST_OUTSTANDING);
 
     ~Master();
+
+    /**
+     * @brief setSpeculationOptions Call before start()
+     */
+    void setSpeculationOptions(const SpeculationOptions& options);
+    /**
+     * @brief setJournal Journal split state to path. If path has the journal of an earlier run
+     * of the same job, the splits it finished aren't sent again. run() exits if the source returns
+     * other splits than the ones the journal was written for. Call before start()
+     */
+    void setJournal(const std::string& path);
     /**
-     * @brief Event loop to send requests and heartbeats to workers and parse responses
+     * @brief Event loop to send requests and heartbeats to workers and parse responses.
+     * Sleeps in poll() until a response arrives, a request slot frees up or a timer is due.
      */
     void run();
 
@@ -37,44 +98,225 @@ private:
      * @param response Includes response and the worker that created it
      */
     void onResponse(const FullRequest& response);
+    /**
+     * @brief onSplitResponse Handles the result of one split, alone or part of a batch
+     * @return false if the copy wasn't in flight on the worker. Copies given up on are in flight until answered
+     */
+    bool onSplitResponse(const std::string& workerName, const FetchSplitResponse& response);
+
+    /**
+     * @brief sendBatch Fills block with a batch for the worker the scheduler picks for the next split
+     * @param maxSplits Max number of splits to take from requests_, at least 1
+     */
+    void sendBatch(base::Block<FullRequest>* block, size_t maxSplits);
+    /**
+     * @brief batchSize Number of splits that keep worker busy for about kTargetBatchMillis_.
+     * 1 until the worker answers its first batch
+     */
+    uint32_t batchSize(WorkerId worker) const;
+    /**
+     * @brief recordBatchTime Updates the time per split of worker with the batch it just answered
+     */
+    void recordBatchTime(WorkerId worker, uint32_t numSplits);
 
     /**
      * @brief onWorkerDead Called when we detect a worker is down (no heartbeat response).
      * @param worker The worker that's done.
      */
     void onWorkerDead(const std::string& worker);
+    /**
+     * @brief dropWorker Reschedules the splits worker is running and forgets about it
+     */
+    void dropWorker(const std::string& worker);
+
+    /**
+     * @brief resizeQueues Sizes requestQueue_ and responseQueue_ after the rate at which
+     * workers get through splits and the number of registered workers.
+     * @param elapsedMillis Time since the last call
+     */
+    void resizeQueues(uint64_t elapsedMillis);
+
+    /**
+     * @brief resetHeartBeatTimeout (Re)starts the timer after which worker is considered dead
+     */
+    void resetHeartBeatTimeout(const std::string& worker);
+    /**
+     * @brief onHeartBeatTimeout Declares worker dead, unless we heard from it since the timer was set.
+     * Then the timer is set again for kHeartBeatTimeout_ after that, so messages don't touch the timer
+     */
+    void onHeartBeatTimeout(const std::string& worker);
 
     /**
-     * @brief getRoundRobinWorker Simple function to choose the next worker in round-robin fashion
-     * @return
+     * @brief resetLackOfProgressTimeout (Re)starts the timer after which the master gives up
      */
-    std::string getRoundRobinWorker();
+    void resetLackOfProgressTimeout();
+    void onLackOfProgress();
+
+    /**
+     * @brief onSplitDeadline Called when a split has been pending for kSplitDeadline_.
+     * Gives up on the copy like on a failed one, so a split stuck on a live worker doesn't hold the window
+     */
+    void onSplitDeadline(SplitId split);
+
+    /**
+     * @brief recordSplitDuration Keeps the last kSplitDurationSamples_ split times for the median
+     */
+    void recordSplitDuration(uint64_t millis);
+
+    /**
+     * @brief sendBackup Sends a copy of s to an idle worker it hasn't failed on
+     * @return false if there is no idle worker or no room in the request queue
+     */
+    bool sendBackup(SplitTrackingInfo& s);
+    /**
+     * @brief reinstateBlacklistedWorker Gives a blacklisted worker that is still registered back to the
+     * scheduler, when there's no other worker left to send splits to
+     */
+    void reinstateBlacklistedWorker();
+    /**
+     * @brief failedWorkerNames Appends the names of the workers s failed on to names
+     */
+    void failedWorkerNames(const SplitTrackingInfo& s, std::vector<std::string>* names) const;
+
+    /**
+     * @brief onSplitFailed A worker answered with an error for a pending split, or missed its deadline.
+     * Waits for the other copy if there is one, otherwise retries the split after a backoff
+     * or gives up after kMaxSplitAttempts_ failures
+     */
+    void onSplitFailed(SplitTrackingInfo& s, bool fromBackup);
+    void onRetryTimer(SplitId split);
+    /**
+     * @brief recordWorkerResult Counts the splits a worker finished and blacklists it
+     * if too many of them failed. @see kBlacklistFailureRate_
+     */
+    void recordWorkerResult(WorkerId worker, bool failed);
+
+    /**
+     * @return kNoWorker if worker never registered
+     */
+    WorkerId workerId(const std::string& worker) const;
+    const std::string& workerName(WorkerId worker) const;
+
+    /**
+     * @brief fillSplitRequest Sets the id of split and its name if the source names splits
+     */
+    void fillSplitRequest(SplitId split, FetchSplitRequest* request) const;
+
+    /**
+     * @brief pullSplits Takes splits from source_ until there are n waiting to be sent
+     * or the source runs out
+     */
+    void pullSplits(size_t n);
+    /**
+     * @return NULL if split is done and was dropped from the window, or doesn't exist yet
+     */
+    SplitTrackingInfo* findSplit(SplitId split);
+    /**
+     * @return whether split is still in the window and pending, so it can be sent
+     */
+    bool waitingToBeSent(SplitId split);
+    /**
+     * @brief dropStaleRequests Removes the ids among the first n of requests_ that can't be sent:
+     * their split is done or was dropped from the window
+     */
+    void dropStaleRequests(size_t n);
+    /**
+     * @brief retireSplits Drops the splits at the front of the window that are done and have no
+     * copies out, so memory follows the splits in flight and not the size of the job
+     */
+    void retireSplits();
+
+    /**
+     * Periodic timers. They schedule themselves again
+     */
+    void onSpeculationTimer();
+    void onHeartBeatSendTimer();
+    void onQueueStatsTimer();
+    void onQueueResizeTimer();
+    void onJournalTimer();
+
+    /**
+     * @brief compactJournal Rewrites the journal from the split window
+     */
+    void compactJournal();
 
 
 
     static const uint64_t kHeartBeatSendFrequency_ = 1000;//every second
+    // workers we heard from more recently than this don't get a heartbeat
+    static const uint64_t kHeartBeatQuietMillis_ = kHeartBeatSendFrequency_;
+
+    // how often to log the stats of the queues (only filled in if enabled on the queues)
+    static const uint64_t kQueueStatsLogFrequency_ = 10000;
+
+    // how often to resize the queues.
+    // Queues grow right away but only shrink to less than half their capacity to avoid flapping
+    static const uint64_t kQueueResizeFrequency_ = 1000;
+    // queue enough splits to keep workers busy for this long at the measured drain rate
+    static const uint64_t kTargetQueueingMillisecs_ = 100;
+    // but never less than this per registered worker
+    static const uint64_t kMinQueueDepthPerWorker_ = 2;
+    static const uint64_t kMinQueueCapacity_ = 5;
+    static const uint64_t kMaxQueueCapacity_ = 65536;
+
+    // max number of split requests written to requestQueue_ in one go
+    static const uint32_t kSplitRequestBurst_ = 64;
+    // splits are sent in batches that take a worker about this long, so the cost of a message
+    // (serialization, zmq frames, a queue slot) is shared by many short splits while long splits
+    // still go one at a time and spread over the workers
+    static const uint64_t kTargetBatchMillis_ = 10;
+    static const uint32_t kMaxSplitsPerBatch_ = 64;
+    // credits of workers that don't advertise any: a full batch running and one waiting
+    static const uint32_t kDefaultWorkerCredits_ = 2 * kMaxSplitsPerBatch_;
+    // max number of responses handled per wake up
+    static const uint32_t kResponseBurst_ = 64;
 
     // if we don't hear from a workers in kHeartBeatTimeout_ seconds consider them dead
     // note that a worker will be busy processing splitRequests so this
     // timeout should be greater than maxProcessingTime/req * maxRequestsInFlight
-    // the max number of requests in flight depends on the size of requestQueue_
+    // the max number of requests in flight is the credits of the worker
     static const uint64_t kHeartBeatTimeout_ = 10000; // a good number is 2 x queueSize x maxTimePerRequest
 
+    // copies of a split pending for longer than this are given up on
+    static const uint64_t kSplitDeadline_ = 10000;
+
+    // how often to look for slow splits once all the splits have been sent
+    static const uint64_t kSpeculationCheckFrequency_ = 100;
+    // number of split times the median is taken from
+    static const uint32_t kSplitDurationSamples_ = 255;
+
+    // a split that failed this many times is marked as ERROR
+    static const uint32_t kMaxSplitAttempts_ = 4;
+    // wait before retrying a failed split, doubled on every failure up to kMaxRetryBackoffMillis_
+    static const uint64_t kRetryBackoffMillis_ = 100;
+    static const uint64_t kMaxRetryBackoffMillis_ = 10000;
+    // workers get no more splits once more than kBlacklistFailureRate_ of their splits failed,
+    // counted after kBlacklistMinSplits_ splits so one early failure doesn't blacklist a worker
+    static const uint64_t kBlacklistMinSplits_ = 10;
+    static const double kBlacklistFailureRate_;
+
     // used to timeout when we don't get responses for a long time.
     // this can happen is all the workers are dead or they don't register in the first place
-    boost::posix_time::ptime lackOfProgressTick_;
     // TODO determine good number, give time to start the workers
     // if we want to detect dead workers this should be greater than kHeartBeatTimeout_
     static const uint64_t kLackOfProgressTimeout_ = 20000;
 
+    // how often journal records are written and synced. A master that crashes loses at most
+    // this much of the journal, and those splits run again
+    static const uint64_t kJournalSyncFrequency_ = 100;
+    // the journal is compacted when it grows past this size
+    static const uint64_t kJournalCompactionBytes_ = 64 << 20;
+
     // request/resopnse queues
     base::ProducerConsumerQueue<base::Block<FullRequest> >* requestQueue_;
+    // heartbeats and shutdowns
+    base::ProducerConsumerQueue<base::Block<FullRequest> >* controlQueue_;
     base::ProducerConsumerQueue<base::Block<FullRequest> >* responseQueue_;
 
-    // map {worker -> last time we got a heartbeat resopnse}
-    std::map<std::string, boost::posix_time::ptime> heartBeatTimeoutTick_;
+    // map {worker -> timer that fires if we don't hear from it in time}
+    std::map<std::string, base::TimerWheel::TimerId> heartBeatTimeoutTimers_;
 
-    int64_t requestsLeft_;
+    // splits pulled from the source that aren't done yet
     int64_t responsesLeft_;
 
     boost::mutex mutex_;
@@ -82,23 +324,104 @@ private:
     // to keep stats
     uint64_t numSplitRequests_;
     uint64_t numSplitResponses_;
+    uint64_t numBatchRequests_;
+    uint64_t numBatchResponses_;
     uint64_t numHeartBeatRequests_;
     uint64_t numHeartBeatResponses_;
+    // heartbeats not sent because the worker wasn't quiet
+    uint64_t numHeartBeatsSkipped_;
     uint64_t numRegistrations_;
+    // numBatchResponses_ the last time the queues were resized
+    uint64_t lastNumBatchResponses_;
 
-    // list of registered workers
+    // list of registered workers, in no particular order
     std::vector<std::string> workers_;
+    // worker -> position in workers_
+    std::map<std::string, size_t> workerIndex_;
+
+    struct WorkerInfo {
+        WorkerInfo(const std::string& _name) :
+            name(_name), ok(0), failed(0), blacklisted(false), credits(0), lastResponseMillis(0), millisPerSplit(-1),
+            lastHeardMillis(0) {}
 
-    // used to track the status of the splits
-    SplitMap requestsInFlight_;
+        std::string name;
+        // ids of the splits sent to it that it hasn't answered yet (including backups and copies
+        // given up on), so a dead worker only costs its own splits. A split given up on
+        // and sent to it again is in twice
+        std::multiset<SplitId> pendingSplits;
+        // answered splits, to blacklist workers that fail too many. @see kBlacklistFailureRate_
+        uint64_t ok;
+        uint64_t failed;
+        bool blacklisted;
+        // the credits it advertised last, to give a blacklisted worker back to the scheduler
+        uint32_t credits;
+        // when the batches it hasn't answered were sent, oldest first. Workers answer batches in order
+        std::deque<uint64_t> batchesSentMillis;
+        uint64_t lastResponseMillis;
+        // moving average of the time it takes per split, negative until it answers a batch
+        double millisPerSplit;
+        // when we last got any message from it
+        uint64_t lastHeardMillis;
+    };
+    // WorkerId -> worker, for every worker that ever registered
+    std::vector<WorkerInfo> workerInfo_;
+    // worker -> WorkerId
+    std::map<std::string, WorkerId> workerIds_;
 
-    // used to send splitRequets and heartbeats in round-robin fashion
-    uint64_t index_;
+    // where the splits come from. Owned
+    SplitSource* source_;
+    bool sourceDone_;
+    // window of splits, from the oldest one not done to the last one pulled from the source.
+    // splits_[i] is split firstSplit_ + i
+    std::deque<SplitTrackingInfo> splits_;
+    // names of the splits in splits_, only if the source names splits
+    std::deque<std::string> splitNames_;
+    // copies sent of the splits in splits_ after their first one
+    SplitAttempts attempts_;
+    SplitId firstSplit_;
+    // splits dropped from the window
+    uint64_t numOkSplits_;
+    uint64_t numErrorSplits_;
+
+    // used to send heartbeats in round-robin fashion
     uint64_t heartBeatIndex_;
 
-    // initial list of requests. Used for rescheduling.
-    std::list<SplitTrackingInfo> requests_;
+    // chooses the worker for every split. Owned
+    Scheduler* scheduler_;
+
+    // splits waiting to be sent: new ones from the source and the rescheduled and retried ones
+    std::deque<SplitId> requests_;
+
+    // slots for the burst of split requests being sent. Kept here to reuse the memory
+    std::vector<base::Block<FullRequest> *> splitRequests_;
+    // same for the responses being handled
+    std::vector<base::Block<FullRequest> *> responses_;
+
+    // ticks in milliseconds
+    base::TimerWheel timers_;
+    base::TimerWheel::TimerId lackOfProgressTimer_;
+    // set by the lack of progress timer
+    bool lackOfProgress_;
+    // timers_.now() the last time the queues were resized
+    uint64_t lastQueueResizeMillis_;
+
+    SpeculationOptions speculation_;
+    // last kSplitDurationSamples_ split times, in milliseconds
+    std::vector<uint64_t> splitDurations_;
+    // {sentMillis, split id} in the order splits were sent. Entries of splits that are done
+    // or were sent again are dropped lazily from the front
+    std::deque<std::pair<uint64_t, SplitId> > sendOrder_;
+    uint32_t numBackupsInFlight_;
+    uint64_t numBackupRequests_;
+    uint64_t numBackupWins_;
+    uint64_t numRetries_;
 
+    // NULL if not journaling. Owned
+    SplitJournal* journal_;
+    // splits finished by an earlier run, according to the journal
+    uint64_t numReplayedSplits_;
+    // set when the splits aren't the ones the journal was written for
+    bool journalMismatch_;
 };
 
 } // namespace distributor
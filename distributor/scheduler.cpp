@@ -0,0 +1,222 @@
+
+#include "distributor/scheduler.h"
+#include <assert.h>
+#include <algorithm>
+#include <boost/random/uniform_int_distribution.hpp>
+
+namespace ddc {
+namespace distributor {
+
+Scheduler* Scheduler::create(SchedulerPolicy::value policy) {
+    switch(policy) {
+        case SchedulerPolicy::ROUND_ROBIN: {
+            return new RoundRobinScheduler();
+        }
+        case SchedulerPolicy::LEAST_OUTSTANDING: {
+            return new LeastOutstandingScheduler();
+        }
+        case SchedulerPolicy::POWER_OF_TWO_CHOICES: {
+            return new PowerOfTwoChoicesScheduler();
+        }
+        default: {
+            assert(0);
+            return NULL;
+        }
+    }
+}
+
+Scheduler::~Scheduler() {
+}
+
+void Scheduler::addWorker(const std::string& worker, uint32_t credits) {
+    if(find(worker) != NULL) {
+        setCredits(worker, credits);
+        return;
+    }
+    WorkerLoad load(worker, credits);
+    if(load.available()) {
+        insert(load);
+    }
+    else {
+        waiting_.insert(std::make_pair(worker, load));
+    }
+}
+
+void Scheduler::removeWorker(const std::string& worker) {
+    std::map<std::string, size_t>::iterator it = index_.find(worker);
+    if(it != index_.end()) {
+        erase(it);
+    }
+    else {
+        waiting_.erase(worker);
+    }
+}
+
+void Scheduler::setCredits(const std::string& worker, uint32_t credits) {
+    const WorkerLoad* current = find(worker);
+    if((current == NULL) || (current->credits == credits)) {
+        return;
+    }
+    WorkerLoad load = *current;
+    load.credits = credits;
+    update(load);
+}
+
+void Scheduler::setMinFreeCredits(const std::string& worker, uint32_t minFreeCredits) {
+    const WorkerLoad* current = find(worker);
+    if((current == NULL) || (current->minFreeCredits == minFreeCredits)) {
+        return;
+    }
+    WorkerLoad load = *current;
+    load.minFreeCredits = minFreeCredits;
+    update(load);
+}
+
+void Scheduler::onSplitSent(const std::string& worker) {
+    changeOutstanding(worker, 1);
+}
+
+void Scheduler::onSplitDone(const std::string& worker) {
+    changeOutstanding(worker, -1);
+}
+
+const std::string& Scheduler::chooseWorkerAvoiding(const std::vector<std::string>& avoid) {
+    const std::string& chosen = chooseWorker();
+    if(std::find(avoid.begin(), avoid.end(), chosen) == avoid.end()) {
+        return chosen;
+    }
+    const WorkerLoad* best = NULL;
+    for(size_t i = 0; i < workers_.size(); i++) {
+        if(((best == NULL) || (workers_[i].outstanding < best->outstanding)) &&
+                (std::find(avoid.begin(), avoid.end(), workers_[i].worker) == avoid.end())) {
+            best = &workers_[i];
+        }
+    }
+    return (best == NULL) ? chosen : best->worker;
+}
+
+uint64_t Scheduler::outstanding(const std::string& worker) const {
+    const WorkerLoad* load = find(worker);
+    return (load == NULL) ? 0 : load->outstanding;
+}
+
+uint64_t Scheduler::freeCredits(const std::string& worker) const {
+    const WorkerLoad* load = find(worker);
+    return (load == NULL) ? 0 : load->freeCredits();
+}
+
+const std::string* Scheduler::idleWorker(const std::vector<std::string>& avoid) const {
+    for(size_t i = 0; i < workers_.size(); i++) {
+        if((workers_[i].outstanding == 0) &&
+                (std::find(avoid.begin(), avoid.end(), workers_[i].worker) == avoid.end())) {
+            return &workers_[i].worker;
+        }
+    }
+    return NULL;
+}
+
+void Scheduler::changeOutstanding(const std::string& worker, int64_t delta) {
+    // splits of workers that are gone aren't tracked
+    const WorkerLoad* current = find(worker);
+    if((current == NULL) || ((delta < 0) && (current->outstanding == 0))) {
+        return;
+    }
+    WorkerLoad load = *current;
+    load.outstanding += delta;
+    update(load);
+}
+
+void Scheduler::update(WorkerLoad load) {
+    std::map<std::string, size_t>::iterator it = index_.find(load.worker);
+    if(it != index_.end()) {
+        WorkerLoad& current = workers_[it->second];
+        uint64_t before = current.outstanding;
+        current = load;
+        onOutstandingChanged(current, before);
+        if(!load.available()) {
+            // set aside until it answers splits
+            erase(it);
+            waiting_.insert(std::make_pair(load.worker, load));
+        }
+        return;
+    }
+    std::map<std::string, WorkerLoad>::iterator waiting = waiting_.find(load.worker);
+    if(waiting == waiting_.end()) {
+        return;
+    }
+    if(load.available()) {
+        waiting_.erase(waiting);
+        insert(load);
+    }
+    else {
+        waiting->second = load;
+    }
+}
+
+void Scheduler::insert(const WorkerLoad& load) {
+    index_[load.worker] = workers_.size();
+    workers_.push_back(load);
+    onWorkerAdded(workers_.back());
+}
+
+void Scheduler::erase(std::map<std::string, size_t>::iterator it) {
+    size_t i = it->second;
+    WorkerLoad removed = workers_[i];
+    index_.erase(it);
+    // fill the hole with the last worker
+    if(i != workers_.size() - 1) {
+        workers_[i] = workers_.back();
+        index_[workers_[i].worker] = i;
+    }
+    workers_.pop_back();
+    onWorkerRemoved(removed);
+}
+
+const Scheduler::WorkerLoad* Scheduler::find(const std::string& worker) const {
+    std::map<std::string, size_t>::const_iterator it = index_.find(worker);
+    if(it != index_.end()) {
+        return &workers_[it->second];
+    }
+    std::map<std::string, WorkerLoad>::const_iterator waiting = waiting_.find(worker);
+    return (waiting == waiting_.end()) ? NULL : &waiting->second;
+}
+
+const std::string& RoundRobinScheduler::chooseWorker() {
+    assert(!workers_.empty());
+    return workers_[next_++ % workers_.size()].worker;
+}
+
+const std::string& LeastOutstandingScheduler::chooseWorker() {
+    assert(!byLoad_.empty());
+    return byLoad_.begin()->second;
+}
+
+void LeastOutstandingScheduler::onWorkerAdded(const WorkerLoad& load) {
+    byLoad_.insert(std::make_pair(load.outstanding, load.worker));
+}
+
+void LeastOutstandingScheduler::onWorkerRemoved(const WorkerLoad& load) {
+    byLoad_.erase(std::make_pair(load.outstanding, load.worker));
+}
+
+void LeastOutstandingScheduler::onOutstandingChanged(const WorkerLoad& load, uint64_t before) {
+    byLoad_.erase(std::make_pair(before, load.worker));
+    byLoad_.insert(std::make_pair(load.outstanding, load.worker));
+}
+
+const std::string& PowerOfTwoChoicesScheduler::chooseWorker() {
+    assert(!workers_.empty());
+    if(workers_.size() == 1) {
+        return workers_[0].worker;
+    }
+    boost::random::uniform_int_distribution<size_t> pick(0, workers_.size() - 1);
+    size_t a = pick(random_);
+    size_t b = pick(random_);
+    while(b == a) {
+        b = pick(random_);
+    }
+    return (workers_[b].outstanding < workers_[a].outstanding) ? workers_[b].worker : workers_[a].worker;
+}
+
+} // namespace distributor
+} // namespace ddc
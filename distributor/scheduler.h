@@ -0,0 +1,179 @@
+#ifndef DDC_DISTRIBUTOR_SCHEDULER_H
+#define DDC_DISTRIBUTOR_SCHEDULER_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace ddc {
+namespace distributor {
+
+class SchedulerPolicy {
+public:
+    enum value {
+        ROUND_ROBIN,
+        LEAST_OUTSTANDING,
+        POWER_OF_TWO_CHOICES
+    };
+};
+
+/**
+ * @brief The Scheduler class decides which worker gets the next split.
+ *
+ * It keeps the list of workers and how many splits each one has outstanding (sent and not
+ * answered yet). The master tells it about registrations, dead workers, splits sent and
+ * responses, and asks chooseWorker() for every split. Subclasses implement the policy.
+ *
+ * Every worker has credits, the number of splits it can have outstanding. Workers without enough
+ * free credits are set aside and the policy doesn't see them until they answer splits or get more
+ * credits, so chooseWorker() needs numAvailableWorkers() > 0. Enough is setMinFreeCredits(), so
+ * a busy worker gets a batch when it has room for one rather than a split per split it answers.
+ */
+class Scheduler {
+public:
+    /**
+     * @brief create Scheduler for the given policy. The caller owns it
+     */
+    static Scheduler* create(SchedulerPolicy::value policy);
+
+    virtual ~Scheduler();
+
+    static const uint32_t kUnlimitedCredits = 0xffffffff;
+
+    /**
+     * @brief addWorker Adds worker, or updates its credits if it is already there
+     */
+    void addWorker(const std::string& worker, uint32_t credits = kUnlimitedCredits);
+    void removeWorker(const std::string& worker);
+    void setCredits(const std::string& worker, uint32_t credits);
+    /**
+     * @brief setMinFreeCredits Free credits worker needs to be chosen, 1 by default.
+     * Capped at its credits
+     */
+    void setMinFreeCredits(const std::string& worker, uint32_t minFreeCredits);
+
+    void onSplitSent(const std::string& worker);
+    void onSplitDone(const std::string& worker);
+
+    /**
+     * @brief chooseWorker Must only be called when numAvailableWorkers() > 0.
+     * The reference is only valid until the next call that changes the workers or their load
+     */
+    virtual const std::string& chooseWorker() = 0;
+    /**
+     * @brief chooseWorkerAvoiding Like chooseWorker() but if the policy picks one of avoid
+     * it falls back to the least loaded worker not in avoid. O(workers x avoid) in that case.
+     * If every worker is in avoid the policy's choice stands
+     */
+    const std::string& chooseWorkerAvoiding(const std::vector<std::string>& avoid);
+
+    uint64_t outstanding(const std::string& worker) const;
+    /**
+     * @brief freeCredits Splits worker can still take
+     */
+    uint64_t freeCredits(const std::string& worker) const;
+    /**
+     * @brief idleWorker A worker not in avoid with no outstanding splits. O(workers x avoid)
+     * @return NULL if every worker is busy or in avoid
+     */
+    const std::string* idleWorker(const std::vector<std::string>& avoid) const;
+
+    size_t numWorkers() const { return workers_.size() + waiting_.size(); }
+    /**
+     * @brief numAvailableWorkers Workers with enough free credits to be chosen
+     */
+    size_t numAvailableWorkers() const { return workers_.size(); }
+
+protected:
+    struct WorkerLoad {
+        WorkerLoad(const std::string& _worker, uint32_t _credits) :
+            worker(_worker), outstanding(0), credits(_credits), minFreeCredits(1) {}
+
+        uint64_t freeCredits() const {
+            return (credits > outstanding) ? credits - outstanding : 0;
+        }
+        bool available() const {
+            return (freeCredits() > 0) && (freeCredits() >= std::min(minFreeCredits, credits));
+        }
+
+        std::string worker;
+        uint64_t outstanding;
+        uint32_t credits;
+        uint32_t minFreeCredits;
+    };
+
+    /**
+     * Hooks for policies that keep their own view of the workers.
+     * Called after workers_ changed
+     */
+    virtual void onWorkerAdded(const WorkerLoad& load) {}
+    virtual void onWorkerRemoved(const WorkerLoad& load) {}
+    virtual void onOutstandingChanged(const WorkerLoad& load, uint64_t before) {}
+
+    // available workers, in no particular order. A removed worker is replaced by the last one
+    std::vector<WorkerLoad> workers_;
+
+private:
+    void changeOutstanding(const std::string& worker, int64_t delta);
+    /**
+     * @brief update Replaces the load of a worker, moving it in or out of workers_ as it becomes
+     * available or not. Takes a copy, names in workers_ move around
+     */
+    void update(WorkerLoad load);
+    void insert(const WorkerLoad& load);
+    void erase(std::map<std::string, size_t>::iterator it);
+    const WorkerLoad* find(const std::string& worker) const;
+
+    // worker -> position in workers_
+    std::map<std::string, size_t> index_;
+    // workers that aren't available, waiting for their splits to be answered
+    std::map<std::string, WorkerLoad> waiting_;
+};
+
+/**
+ * @brief Next worker in turn, regardless of how busy it is
+ */
+class RoundRobinScheduler: public Scheduler {
+public:
+    RoundRobinScheduler() : next_(0) {}
+    const std::string& chooseWorker();
+private:
+    uint64_t next_;
+};
+
+/**
+ * @brief The worker with the fewest outstanding splits. O(log(workers))
+ */
+class LeastOutstandingScheduler: public Scheduler {
+public:
+    const std::string& chooseWorker();
+protected:
+    void onWorkerAdded(const WorkerLoad& load);
+    void onWorkerRemoved(const WorkerLoad& load);
+    void onOutstandingChanged(const WorkerLoad& load, uint64_t before);
+private:
+    // {outstanding, worker}, least loaded first
+    std::set<std::pair<uint64_t, std::string> > byLoad_;
+};
+
+/**
+ * @brief The least loaded of two workers picked at random.
+ * Close to least outstanding without keeping the workers sorted.
+ */
+class PowerOfTwoChoicesScheduler: public Scheduler {
+public:
+    PowerOfTwoChoicesScheduler() : random_(5489u) {}
+    const std::string& chooseWorker();
+private:
+    boost::random::mt19937 random_;
+};
+
+} // namespace distributor
+} // namespace ddc
+
+#endif // DDC_DISTRIBUTOR_SCHEDULER_H
@@ -2,9 +2,13 @@
 #ifndef DDC_DISTRIBUTOR_SPLIT_H
 #define DDC_DISTRIBUTOR_SPLIT_H
 
+#include <stdint.h>
+#include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
 
+#include "base/timerwheel.h"
 #include "distributor.pb.h"
 
 namespace ddc {
@@ -20,41 +24,200 @@ public:
 };
 
 
+// splits are numbered 0..n-1, in the order they are created
+typedef uint64_t SplitId;
 
-struct SplitTrackingInfo {
-    SplitTrackingInfo(const std::string& _id) :
+// handle of a worker, so split tracking doesn't keep copies of the worker names.
+// Handles are never reused. @see Master::workerInfo_
+typedef uint32_t WorkerId;
+static const WorkerId kNoWorker = 0xffffffff;
+
+/**
+ * @brief One copy of a split sent to a worker: the first send, a retry or a speculative backup
+ */
+struct SplitAttempt {
+    // not sent yet
+    SplitAttempt() :
+        worker(kNoWorker),
         status(Status::PENDING),
-        worker(""),
-        id(_id)
+        sentMillis(0)
     {
 
     }
 
-    SplitTrackingInfo(const std::string& _id,
-                      const std::string& _worker) :
-        status(Status::PENDING),
+    SplitAttempt(WorkerId _worker, uint64_t _sentMillis) :
         worker(_worker),
-        id(_id)
+        status(Status::PENDING),
+        sentMillis(_sentMillis)
+    {
+
+    }
+
+    WorkerId worker;
+    // PENDING until the worker answers, ERROR if it missed its deadline. Stays PENDING if the worker died
+    Status::value status;
+    uint64_t sentMillis;
+};
+
+/**
+ * @brief State of a split. The master keeps the splits it is working on in a window ordered by id
+ */
+struct SplitTrackingInfo {
+    SplitTrackingInfo() :
+        status(Status::PENDING),
+        worker(kNoWorker),
+        backupWorker(kNoWorker),
+        copiesInFlight(0),
+        id(0),
+        deadlineTimer(base::TimerWheel::kNoTimer),
+        sentMillis(0),
+        retried(false)
     {
 
     }
 
     Status::value status;
-    std::string worker;
-    std::string id;
+    // worker running the split, kNoWorker if it hasn't been sent or is waiting to be sent again
+    WorkerId worker;
+    // worker running a speculative copy of the split, kNoWorker if there is none
+    WorkerId backupWorker;
+    // copies sent that haven't been answered or given up on, by workers that are still alive
+    uint32_t copiesInFlight;
+    SplitId id;
+    // fires if the split is still pending after Master::kSplitDeadline_
+    base::TimerWheel::TimerId deadlineTimer;
+    // when the split was last sent, in Master's timer wheel milliseconds
+    uint64_t sentMillis;
+    // the first copy sent. Most splits are only sent once, the later copies are in a SplitAttempts
+    SplitAttempt firstAttempt;
+    // whether more than one copy was sent
+    bool retried;
+};
+
+/**
+ * @brief Every copy sent of the splits in the window. The first copy of a split is kept in its
+ * SplitTrackingInfo, only the splits sent again (retries and backups) get an entry here
+ */
+class SplitAttempts {
+public:
+    /**
+     * @brief add Records a copy of s sent to worker
+     */
+    void add(SplitTrackingInfo& s, WorkerId worker, uint64_t sentMillis) {
+        if(s.firstAttempt.worker == kNoWorker) {
+            s.firstAttempt = SplitAttempt(worker, sentMillis);
+            return;
+        }
+        s.retried = true;
+        later_[s.id].push_back(SplitAttempt(worker, sentMillis));
+    }
+
+    /**
+     * @brief done Records the answer of worker to its latest copy of s
+     */
+    void done(SplitTrackingInfo& s, WorkerId worker, Status::value status) {
+        if(s.retried) {
+            std::vector<SplitAttempt>& later = later_[s.id];
+            for(std::vector<SplitAttempt>::reverse_iterator it = later.rbegin(); it != later.rend(); ++it) {
+                if((it->worker == worker) && (it->status == Status::PENDING)) {
+                    it->status = status;
+                    return;
+                }
+            }
+        }
+        if((s.firstAttempt.worker == worker) && (s.firstAttempt.status == Status::PENDING)) {
+            s.firstAttempt.status = status;
+        }
+    }
+
+    /**
+     * @brief running Whether the latest copy of s sent to worker is still waiting for an answer
+     */
+    bool running(const SplitTrackingInfo& s, WorkerId worker) const {
+        if(s.retried) {
+            const std::vector<SplitAttempt>& later = later_.find(s.id)->second;
+            for(std::vector<SplitAttempt>::const_reverse_iterator it = later.rbegin(); it != later.rend(); ++it) {
+                if(it->worker == worker) {
+                    return it->status == Status::PENDING;
+                }
+            }
+        }
+        return (s.firstAttempt.worker == worker) && (s.firstAttempt.status == Status::PENDING);
+    }
+
+    uint32_t numFailures(const SplitTrackingInfo& s) const {
+        std::vector<WorkerId> failed;
+        failedWorkers(s, &failed);
+        return failed.size();
+    }
+
+    /**
+     * @brief failedOn Whether a copy of s failed on worker
+     */
+    bool failedOn(const SplitTrackingInfo& s, WorkerId worker) const {
+        std::vector<WorkerId> failed;
+        failedWorkers(s, &failed);
+        return std::find(failed.begin(), failed.end(), worker) != failed.end();
+    }
+
+    /**
+     * @brief failedWorkers Appends the workers s failed on to workers, once per failure
+     */
+    void failedWorkers(const SplitTrackingInfo& s, std::vector<WorkerId>* workers) const {
+        if(s.firstAttempt.status == Status::ERROR) {
+            workers->push_back(s.firstAttempt.worker);
+        }
+        if(!s.retried) {
+            return;
+        }
+        const std::vector<SplitAttempt>& later = later_.find(s.id)->second;
+        for(size_t i = 0; i < later.size(); i++) {
+            if(later[i].status == Status::ERROR) {
+                workers->push_back(later[i].worker);
+            }
+        }
+    }
+
+    /**
+     * @brief erase Forgets the copies of s, when it leaves the window
+     */
+    void erase(const SplitTrackingInfo& s) {
+        if(s.retried) {
+            later_.erase(s.id);
+        }
+    }
+
+private:
+    // copies after the first one, oldest first
+    std::map<SplitId, std::vector<SplitAttempt> > later_;
 };
 
 struct FullRequest {
     AnyRequest protoMessage;
     std::string worker; // worker this req is addressed to
 
-};
-
-typedef std::map<std::string, SplitTrackingInfo> SplitMap;
-typedef std::map<std::string, SplitTrackingInfo>::const_iterator SplitMapConstIt;
-typedef std::map<std::string, SplitTrackingInfo>::iterator SplitMapIt;
+    /**
+     * @brief emplace Start building a new message in place.
+     * Clear() keeps the sub-messages and strings of the previous message, so refilling a queue
+     * block reuses its memory instead of allocating and copying a message built elsewhere.
+     * @return The message to fill in
+     */
+    AnyRequest& emplace(AnyRequest_Type type, const std::string& _worker) {
+        protoMessage.Clear();
+        protoMessage.set_type(type);
+        worker = _worker;
+        return protoMessage;
+    }
 
+    void swap(FullRequest& other) {
+        protoMessage.Swap(&other.protoMessage);
+        worker.swap(other.worker);
+    }
+};
 
+inline void swap(FullRequest& a, FullRequest& b) {
+    a.swap(b);
+}
 
 } // namespace distributor
 } // namespace ddc
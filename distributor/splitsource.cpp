@@ -0,0 +1,101 @@
+
+#include "distributor/splitsource.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <glog/logging.h>
+
+namespace ddc {
+namespace distributor {
+
+SplitSource::~SplitSource() {
+}
+
+bool GeneratorSplitSource::next(std::string* name) {
+    if(next_ == numSplits_) {
+        return false;
+    }
+    ++next_;
+    return true;
+}
+
+ManifestSplitSource::ManifestSplitSource(const std::string& path) :
+    path_(path),
+    file_(path.c_str())
+{
+    if(!file_.is_open()) {
+        LOG(ERROR) << "can't open manifest " << path_ << ": " << strerror(errno);
+    }
+}
+
+bool ManifestSplitSource::next(std::string* name) {
+    while(std::getline(file_, *name)) {
+        // manifests written on windows
+        if(!name->empty() && ((*name)[name->size() - 1] == '\r')) {
+            name->resize(name->size() - 1);
+        }
+        if(!name->empty()) {
+            return true;
+        }
+    }
+    if(file_.bad()) {
+        LOG(ERROR) << "error reading manifest " << path_;
+    }
+    return false;
+}
+
+DirectorySplitSource::DirectorySplitSource(const std::string& path) {
+    openDirectory(path);
+}
+
+DirectorySplitSource::~DirectorySplitSource() {
+    for(size_t i = 0; i < directories_.size(); i++) {
+        closedir(directories_[i].dir);
+    }
+}
+
+void DirectorySplitSource::openDirectory(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if(dir == NULL) {
+        LOG(ERROR) << "can't open directory " << path << ": " << strerror(errno);
+        return;
+    }
+    directories_.push_back(OpenDirectory(dir, path));
+}
+
+bool DirectorySplitSource::next(std::string* name) {
+    while(!directories_.empty()) {
+        struct dirent* entry = readdir(directories_.back().dir);
+        if(entry == NULL) {
+            // done with this one, back to its parent
+            closedir(directories_.back().dir);
+            directories_.pop_back();
+            continue;
+        }
+        if((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) {
+            continue;
+        }
+        std::string path = directories_.back().path + "/" + entry->d_name;
+        unsigned char type = entry->d_type;
+        if(type == DT_UNKNOWN) {
+            // not every file system fills in d_type
+            struct stat st;
+            if(lstat(path.c_str(), &st) != 0) {
+                LOG(ERROR) << "can't stat " << path << ": " << strerror(errno);
+                continue;
+            }
+            type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+        }
+        if(type == DT_DIR) {
+            openDirectory(path);
+        }
+        else if(type == DT_REG) {
+            name->swap(path);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace distributor
+} // namespace ddc
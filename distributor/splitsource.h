@@ -0,0 +1,93 @@
+#ifndef DDC_DISTRIBUTOR_SPLITSOURCE_H
+#define DDC_DISTRIBUTOR_SPLITSOURCE_H
+
+#include <dirent.h>
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ddc {
+namespace distributor {
+
+/**
+ * @brief The SplitSource class lists the splits of a job.
+ *
+ * The master pulls splits with next() as it has room to send them, so a source only needs to
+ * produce one split at a time and the job can start before the whole list is known.
+ * Splits get ids 0, 1, 2 ... in the order next() returns them.
+ */
+class SplitSource {
+public:
+    virtual ~SplitSource();
+
+    /**
+     * @brief next Gets the next split
+     * @param name Set to the name of the split (e.g. a file path) if hasNames()
+     * @return false once there are no more splits
+     */
+    virtual bool next(std::string* name) = 0;
+
+    /**
+     * @brief hasNames Whether next() names the splits. Splits without a name are only
+     * known by their id
+     */
+    virtual bool hasNames() const = 0;
+};
+
+/**
+ * @brief numSplits splits without names
+ */
+class GeneratorSplitSource: public SplitSource {
+public:
+    explicit GeneratorSplitSource(uint64_t numSplits) : numSplits_(numSplits), next_(0) {}
+    bool next(std::string* name);
+    bool hasNames() const { return false; }
+private:
+    uint64_t numSplits_;
+    uint64_t next_;
+};
+
+/**
+ * @brief One split per non empty line of a text file, named after the line.
+ * The file is read as splits are needed
+ */
+class ManifestSplitSource: public SplitSource {
+public:
+    explicit ManifestSplitSource(const std::string& path);
+    bool next(std::string* name);
+    bool hasNames() const { return true; }
+private:
+    std::string path_;
+    std::ifstream file_;
+};
+
+/**
+ * @brief One split per regular file under a directory and its subdirectories, named after
+ * the file's path. Symbolic links aren't followed. The tree is walked as splits are needed,
+ * keeping open only the directories on the way to the current one
+ */
+class DirectorySplitSource: public SplitSource {
+public:
+    explicit DirectorySplitSource(const std::string& path);
+    ~DirectorySplitSource();
+    bool next(std::string* name);
+    bool hasNames() const { return true; }
+private:
+    struct OpenDirectory {
+        OpenDirectory(DIR* _dir, const std::string& _path) : dir(_dir), path(_path) {}
+
+        DIR* dir;
+        std::string path;
+    };
+
+    void openDirectory(const std::string& path);
+
+    // directories being walked, innermost last
+    std::vector<OpenDirectory> directories_;
+};
+
+} // namespace distributor
+} // namespace ddc
+
+#endif // DDC_DISTRIBUTOR_SPLITSOURCE_H
@@ -1,6 +1,7 @@
 
 #include "distributor/transport.h"
 #include <string>
+#include <vector>
 #include <glog/logging.h>
 #include "distributor/zmqutils.h"
 
@@ -8,8 +9,10 @@ namespace ddc {
 namespace distributor {
 
 Transport::Transport(base::ProducerConsumerQueue<base::Block<FullRequest> >* requestQueue,
+        base::ProducerConsumerQueue<base::Block<FullRequest> >* controlQueue,
         base::ProducerConsumerQueue<base::Block<FullRequest> >* responseQueue) :
     requestQueue_(requestQueue),
+    controlQueue_(controlQueue),
     responseQueue_(responseQueue) {
 }
 
@@ -34,6 +37,12 @@ static std::string enumToString(AnyRequest_Type type) {
         case 6: {
             return std::string("SHUTDOWN_REQUEST");
         }
+        case 7: {
+            return std::string("FETCH_SPLIT_BATCH_REQUEST");
+        }
+        case 8: {
+            return std::string("FETCH_SPLIT_BATCH_RESPONSE");
+        }
         default: {
             return std::string("UNKNOWN");
         }
@@ -41,6 +50,25 @@ static std::string enumToString(AnyRequest_Type type) {
 }
 
 
+void Transport::sendRequests(zmq::socket_t& socket,
+                             base::ProducerConsumerQueue<base::Block<FullRequest> >* queue,
+                             std::vector<base::Block<FullRequest> *>& requests) {
+    // take everything that is ready with a single lock
+    if(queue->tryGetReadSlots(requests, kMaxRequestsPerPoll_) == 0) {
+        return;
+    }
+    for(int i = 0; i < requests.size(); i++) {
+        base::Block<FullRequest> *request = requests[i];
+        s_sendmore(socket, request->data.worker);
+        s_sendmore(socket, "");  // envelope delimiter
+        s_send(socket, request->data.protoMessage);
+        LOG(INFO) << "TRANSPORT: sending req of type " <<
+                     enumToString(request->data.protoMessage.type()) <<
+                     " to worker " << request->data.worker;
+    }
+    queue->slotsRead(requests);
+}
+
 void Transport::run() {
     LOG(INFO) << "starting transport";
 
@@ -52,12 +80,17 @@ void Transport::run() {
 
     socket.bind("tcp://*:5671");
 
+    // wait for worker messages and for requests from the master at the same time
     zmq::pollitem_t items [] = {
-        { socket, 0, ZMQ_POLLIN, 0 }
+        { socket, 0, ZMQ_POLLIN, 0 },
+        { NULL, requestQueue_->readFd(), ZMQ_POLLIN, 0 },
+        { NULL, controlQueue_->readFd(), ZMQ_POLLIN, 0 }
     };
 
+    std::vector<base::Block<FullRequest> *> requests;
+
     while (1) {
-        zmq::poll(&items[0], 1, kZmqPollIntervalMillisecs_);
+        zmq::poll(&items[0], 3, kZmqPollIntervalMillisecs_);
 
         if (items[0].revents & ZMQ_POLLIN) {
             /**
@@ -65,14 +98,8 @@ void Transport::run() {
              */
             std::string worker = s_recv(socket);
             s_recv(socket);  // envelope
-            std::string responseStr = s_recv(socket);
-
-            AnyRequest any;
-            any.ParseFromString(responseStr);
-
-            LOG(INFO) << "TRANSPORT: receiving rsp of type " <<
-                         enumToString(any.type()) <<
-                         " from worker " << worker;
+            zmq::message_t payload;
+            socket.recv(&payload);
 
             /**
              * put response in the queue so master can process it
@@ -81,26 +108,28 @@ void Transport::run() {
             // Warning, make sure this is the only base::Blocking wait.
             // Otherwise we may deadlock
             while(!responseQueue_->tryGetWriteSlot(&response)) {
+                // the master may be gone and not reading responses anymore,
+                // e.g. when the losing copy of a speculative split answers late
+                boost::this_thread::interruption_point();
             }
-            // we got a slot, write response
-            response->data.protoMessage = any;
-            response->data.worker = worker;
+            // we got a slot, parse the response straight into it
+            response->data.protoMessage.ParseFromArray(payload.data(), payload.size());
+            response->data.worker.swap(worker);
+
+            LOG(INFO) << "TRANSPORT: receiving rsp of type " <<
+                         enumToString(response->data.protoMessage.type()) <<
+                         " from worker " << response->data.worker;
             responseQueue_->slotWritten(response);
         }
         /**
-         * send requests to workers
+         * send requests to workers.
+         * heartbeats and shutdowns go before any split request
          */
-        base::Block<FullRequest> *request;
-        if(requestQueue_->tryGetReadSlot(&request)) {
-            // convert protobuf to string
-            std::string requestStr = (request->data.protoMessage).SerializeAsString();
-            s_sendmore(socket, request->data.worker);
-            s_sendmore(socket, "");  // envelope delimiter
-            s_send(socket, requestStr);
-            LOG(INFO) << "TRANSPORT: sending req of type " <<
-                         enumToString(request->data.protoMessage.type()) <<
-                         " to worker " << request->data.worker;
-            requestQueue_->slotRead(request);
+        if(items[2].revents & ZMQ_POLLIN) {
+            sendRequests(socket, controlQueue_, requests);
+        }
+        if(items[1].revents & ZMQ_POLLIN) {
+            sendRequests(socket, requestQueue_, requests);
         }
         boost::this_thread::interruption_point();
     }
@@ -2,6 +2,8 @@
 #ifndef DDC_DISTRIBUTOR_TRANSPORT_H_
 #define DDC_DISTRIBUTOR_TRANSPORT_H_
 
+#include <vector>
+#include <zmq.hpp>
 #include "base/producerconsumerqueue.h"
 #include "base/runnable.h"
 #include "distributor/split.h"
@@ -19,9 +21,11 @@ class Transport: public base::Runnable  {
     /**
      * @brief Transport
      * @param requestQueue Thread-safe request queue
+     * @param controlQueue Thread-safe queue for heartbeats and shutdowns. Always sent before requestQueue
      * @param responseQueue Thread-safe response queue
      */
     Transport(base::ProducerConsumerQueue<base::Block<FullRequest> >* requestQueue,
+            base::ProducerConsumerQueue<base::Block<FullRequest> >* controlQueue,
             base::ProducerConsumerQueue<base::Block<FullRequest> >* responseQueue);
 
     /**
@@ -30,9 +34,21 @@ class Transport: public base::Runnable  {
     void run();
 
  private:
+    /**
+     * @brief sendRequests Send the requests that are ready in queue to the workers
+     * @param requests Scratch space for the blocks taken from queue
+     */
+    void sendRequests(zmq::socket_t& socket,
+                      base::ProducerConsumerQueue<base::Block<FullRequest> >* queue,
+                      std::vector<base::Block<FullRequest> *>& requests);
+
     base::ProducerConsumerQueue<base::Block<FullRequest> >* requestQueue_;
+    base::ProducerConsumerQueue<base::Block<FullRequest> >* controlQueue_;
     base::ProducerConsumerQueue<base::Block<FullRequest> >* responseQueue_;
-    static const uint64_t kZmqPollIntervalMillisecs_ = 1000;  // every 10ms
+    // poll wakes up as soon as there is a message or a request, this only bounds how long cancel() takes
+    static const uint64_t kZmqPollIntervalMillisecs_ = 1000;
+    // max number of requests taken from requestQueue_ in one go
+    static const uint32_t kMaxRequestsPerPoll_ = 256;
 };
 
 }  // namespace distributor
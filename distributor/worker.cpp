@@ -1,5 +1,6 @@
 
 #include "worker.h"
+#include <algorithm>
 #include <glog/logging.h>
 #include <zmq.hpp>
 #include "distributor.pb.h"
@@ -8,6 +9,26 @@
 namespace ddc {
 namespace distributor {
 
+uint32_t Worker::credits() const {
+    if(millisPerSplit_ < 0) {
+        // one running and one waiting until we know better
+        return 2;
+    }
+    if(millisPerSplit_ * (kMaxCredits_ - 1) <= kQueuedMillis_) {
+        return kMaxCredits_;
+    }
+    return 1 + std::max<uint32_t>(1, kQueuedMillis_ / millisPerSplit_);
+}
+
+void Worker::recordSplitTime(uint64_t millis) {
+    if(millisPerSplit_ < 0) {
+        millisPerSplit_ = millis;
+    }
+    else {
+        millisPerSplit_ = 0.75 * millisPerSplit_ + 0.25 * millis;
+    }
+}
+
 void Worker::run() {
     LOG(INFO) << "starting worker";
     zmq::context_t context(1);
@@ -26,6 +47,7 @@ void Worker::run() {
     rsp.set_type(AnyRequest_Type_REGISTRATION);
     Registration *r = new Registration;
     r->set_id(id);
+    r->set_credits(credits());
     rsp.set_allocated_registration(r);
     std::string responseStr = rsp.SerializeAsString();
     s_sendmore(socket, "");
@@ -44,13 +66,34 @@ void Worker::run() {
             rsp.set_type(AnyRequest_Type_FETCH_SPLIT_RESPONSE);
             FetchSplitResponse *r = new FetchSplitResponse;
             r->set_status(0);
-            r->set_filename(req.fetchsplitrequest().filename());
+            r->set_id(req.fetchsplitrequest().id());
             rsp.set_allocated_fetchsplitresponse(r);
             std::string responseStr = rsp.SerializeAsString();
             s_sleep(within(1000));
             s_sendmore(socket, "");
             s_send(socket, responseStr);
-            LOG(INFO) << "sending splitResponse for split " << req.fetchsplitrequest().filename();
+            LOG(INFO) << "sending splitResponse for split " << req.fetchsplitrequest().id();
+        }
+        else if(type == AnyRequest_Type_FETCH_SPLIT_BATCH_REQUEST) {
+            // run the splits in order and answer them all at once
+            const FetchSplitBatchRequest& batch = req.fetchsplitbatchrequest();
+            AnyRequest rsp;
+            rsp.set_type(AnyRequest_Type_FETCH_SPLIT_BATCH_RESPONSE);
+            FetchSplitBatchResponse *r = rsp.mutable_fetchsplitbatchresponse();
+            for(int i = 0; i < batch.splits_size(); i++) {
+                int64_t start = s_clock();
+                s_sleep(within(1000));
+                recordSplitTime(s_clock() - start);
+                FetchSplitResponse *split = r->add_splits();
+                split->set_status(0);
+                split->set_id(batch.splits(i).id());
+            }
+            r->set_credits(credits());
+            std::string responseStr = rsp.SerializeAsString();
+            s_sendmore(socket, "");
+            s_send(socket, responseStr);
+            LOG(INFO) << "sending splitResponse for a batch of " << batch.splits_size() << " splits, " <<
+                         r->credits() << " credits";
         }
         else if(type == AnyRequest_Type_HEARTBEAT_REQUEST) {
             AnyRequest rsp;
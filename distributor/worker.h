@@ -2,14 +2,34 @@
 #ifndef DDC_DISTRIBUTOR_WORKER_H
 #define DDC_DISTRIBUTOR_WORKER_H
 
+#include <stdint.h>
 #include "base/runnable.h"
 
 namespace ddc {
 namespace distributor {
 
+/**
+ * @brief The Worker class runs the splits the master sends it, one at a time.
+ *
+ * It advertises credits, how many splits the master can have sent it without an answer: the
+ * one running plus enough queued behind it to cover kQueuedMillis_, going by how long its
+ * splits have taken so far. A slow worker then holds few splits and a fast one many.
+ */
 class Worker: public base::Runnable  {
 public:
+    Worker() : millisPerSplit_(-1) {}
     void run();
+
+private:
+    uint32_t credits() const;
+    void recordSplitTime(uint64_t millis);
+
+    // work queued behind the running split, covers the round trip to the master and back
+    static const uint64_t kQueuedMillis_ = 100;
+    static const uint32_t kMaxCredits_ = 256;
+
+    // moving average, negative until the first split is done
+    double millisPerSplit_;
 };
 
 } // namespace distributor
@@ -46,6 +46,17 @@ s_send (zmq::socket_t & socket, const std::string & string) {
     return (rc);
 }
 
+//  Serialize protobuf straight into a 0MQ message and send to socket
+bool
+s_send (zmq::socket_t & socket, const ::google::protobuf::MessageLite & proto) {
+
+    zmq::message_t message(proto.ByteSize());
+    proto.SerializeWithCachedSizesToArray(static_cast< ::google::protobuf::uint8*>(message.data()));
+
+    bool rc = socket.send (message);
+    return (rc);
+}
+
 //  Sends string as 0MQ string, as multipart non-terminal
 bool
 s_sendmore (zmq::socket_t & socket, const std::string & string) {
@@ -2,6 +2,7 @@
 #define DDC_DISTRIBUTOR_ZMQUTILS_H
 
 #include <zmq.hpp>
+#include <google/protobuf/message_lite.h>
 
 #define within(num) (int) ((float) (num) * random () / (RAND_MAX + 1.0))
 
@@ -22,6 +23,10 @@ s_recv_non_blocking (zmq::socket_t & socket);
 bool
 s_send (zmq::socket_t & socket, const std::string & string);
 
+//  Serialize protobuf straight into a 0MQ message and send to socket
+bool
+s_send (zmq::socket_t & socket, const ::google::protobuf::MessageLite & proto);
+
 //  Sends string as 0MQ string, as multipart non-terminal
 bool
 s_sendmore (zmq::socket_t & socket, const std::string & string);
@@ -0,0 +1,302 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+
+#include "distributor/journal.h"
+
+/**
+ * Writes, tears, replays and compacts split journals and checks the status every split gets back
+ * after a restart. Also times append() + sync() for the batches the master writes.
+ *
+ * $ make journal_check && ./journal_check [dir]    # journals go to a temporary directory in dir, /tmp by default
+ */
+
+using namespace ddc::distributor;
+
+typedef std::vector<Status::value> Statuses;
+
+static int numFailures = 0;
+
+static void check(bool ok, const std::string& what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what.c_str());
+    if(!ok) {
+        ++numFailures;
+    }
+}
+
+// the name of split i in version v of the job
+static std::string splitName(uint64_t i, int version) {
+    return (boost::format("split-%d-v%d") % i % version).str();
+}
+
+static uint64_t fileSize(const std::string& path) {
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+}
+
+static void appendGarbage(const std::string& path, size_t bytes) {
+    std::vector<char> garbage(bytes, static_cast<char>(0xab));
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+    if((fd < 0) || (write(fd, &garbage[0], garbage.size()) != static_cast<ssize_t>(garbage.size()))) {
+        check(false, "append garbage to " + path);
+    }
+    if(fd >= 0) {
+        close(fd);
+    }
+}
+
+/**
+ * @brief restart Opens the journal like a restarted master would and asks for the first n splits
+ * @return false if the journal can't be opened or the splits don't match it
+ */
+static bool restart(SplitJournal* journal, uint64_t n, int version, Statuses* statuses) {
+    statuses->clear();
+    if(!journal->open()) {
+        return false;
+    }
+    for(uint64_t i = 0; i < n; i++) {
+        Status::value status;
+        if(!journal->replayedStatus(i, splitName(i, version), &status)) {
+            return false;
+        }
+        statuses->push_back(status);
+    }
+    return true;
+}
+
+/**
+ * @brief runJob Appends what a master would for the splits that are still pending:
+ * a dispatch, then split i fails when i % 3 == 0 and succeeds otherwise. Only the splits below
+ * done are answered, the rest stay dispatched. Fills expected with the status each split should have
+ */
+static void runJob(SplitJournal* journal, const Statuses& replayed, uint64_t done, Statuses* expected) {
+    *expected = replayed;
+    for(uint64_t i = 0; i < replayed.size(); i++) {
+        if(replayed[i] != Status::PENDING) {
+            continue;
+        }
+        journal->append(i, JournalRecordType::DISPATCHED);
+        if(i < done) {
+            bool failed = (i % 3) == 0;
+            journal->append(i, failed ? JournalRecordType::ERROR : JournalRecordType::OK);
+            (*expected)[i] = failed ? Status::ERROR : Status::OK;
+        }
+    }
+}
+
+static std::vector<std::pair<SplitId, Status::value> > doneFrom(const Statuses& statuses, uint64_t watermark) {
+    std::vector<std::pair<SplitId, Status::value> > done;
+    for(uint64_t i = watermark; i < statuses.size(); i++) {
+        if(statuses[i] != Status::PENDING) {
+            done.push_back(std::make_pair(i, statuses[i]));
+        }
+    }
+    return done;
+}
+
+static void checkReplay(const std::string& dir) {
+    const std::string path = dir + "/replay";
+    const uint64_t n = 1000;
+    Statuses replayed, expected;
+    {
+        SplitJournal journal(path);
+        check(restart(&journal, n, 1, &replayed), "new journal opens");
+        check(replayed == Statuses(n, Status::PENDING), "new journal has nothing done");
+        runJob(&journal, replayed, 600, &expected);
+        check(journal.sync(), "sync");
+    }
+    {
+        SplitJournal journal(path);
+        check(restart(&journal, n, 1, &replayed), "journal replays");
+        check(replayed == expected, "replayed statuses are the ones written");
+        // the rest of the job, nothing new fails
+        for(uint64_t i = 600; i < n; i++) {
+            journal.append(i, JournalRecordType::OK);
+            expected[i] = Status::OK;
+        }
+        // a split written twice keeps its last record
+        journal.append(n - 1, JournalRecordType::ERROR);
+        expected[n - 1] = Status::ERROR;
+        check(journal.sync(), "sync after replay");
+    }
+    SplitJournal journal(path);
+    check(restart(&journal, n, 1, &replayed), "journal replays again");
+    check(replayed == expected, "the last record of a split wins");
+}
+
+static void checkTornTail(const std::string& dir) {
+    const std::string path = dir + "/torn";
+    const uint64_t n = 100;
+    Statuses replayed, expected;
+    {
+        SplitJournal journal(path);
+        restart(&journal, n, 1, &replayed);
+        runJob(&journal, replayed, 50, &expected);
+        journal.sync();
+    }
+    const uint64_t size = fileSize(path);
+    // less than a record, and more than one record of garbage
+    const size_t garbage[] = {7, 100};
+    for(size_t i = 0; i < sizeof(garbage) / sizeof(garbage[0]); i++) {
+        appendGarbage(path, garbage[i]);
+        SplitJournal journal(path);
+        check(restart(&journal, n, 1, &replayed), (boost::format("journal with %d torn bytes replays") % garbage[i]).str());
+        check(replayed == expected, "torn bytes don't change the statuses");
+        check((journal.bytes() == size) && (fileSize(path) == size), "torn bytes are truncated");
+    }
+    {
+        // appends after the truncation are read back
+        SplitJournal journal(path);
+        restart(&journal, n, 1, &replayed);
+        journal.append(60, JournalRecordType::OK);
+        expected[60] = Status::OK;
+        journal.sync();
+    }
+    SplitJournal journal(path);
+    check(restart(&journal, n, 1, &replayed) && (replayed == expected), "appends after a truncation replay");
+}
+
+static void checkCompaction(const std::string& dir) {
+    const std::string path = dir + "/compact";
+    const uint64_t n = 1000;
+    Statuses replayed, expected;
+    {
+        SplitJournal journal(path);
+        restart(&journal, n, 1, &replayed);
+        runJob(&journal, replayed, 500, &expected);
+        journal.sync();
+        uint64_t before = journal.bytes();
+        // like the master: everything below the window is done, the window is passed as done
+        check(journal.compact(400, doneFrom(expected, 400)), "compact");
+        check(journal.bytes() < before, "compaction shrinks the journal");
+        check(journal.bytes() == fileSize(path), "bytes() is the size of the compacted file");
+        check(access((path + ".tmp").c_str(), F_OK) != 0, "no temporary file is left");
+        // appends after the compaction go to the new file
+        journal.append(700, JournalRecordType::OK);
+        expected[700] = Status::OK;
+    }
+    {
+        SplitJournal journal(path);
+        check(restart(&journal, n, 1, &replayed), "compacted journal replays");
+        check(journal.watermark() == 400, "the watermark is the one compacted at");
+        check(replayed == expected, "failed splits below the watermark are still failed");
+    }
+    {
+        // a restarted master compacts before it has asked for every replayed split
+        SplitJournal journal(path);
+        check(restart(&journal, 600, 1, &replayed), "compacted journal replays the first splits");
+        check(journal.compact(450, doneFrom(replayed, 450)), "compact again");
+    }
+    SplitJournal journal(path);
+    check(restart(&journal, n, 1, &replayed), "journal compacted twice replays");
+    Statuses twice(expected);
+    for(uint64_t i = 0; i < 450; i++) {
+        if(twice[i] == Status::PENDING) {
+            // below the watermark: done as far as the journal knows
+            twice[i] = Status::OK;
+        }
+    }
+    check(replayed == twice, "statuses survive two compactions");
+}
+
+static void checkMismatch(const std::string& dir) {
+    const std::string path = dir + "/mismatch";
+    const uint64_t n = 100;
+    Statuses replayed, expected;
+    {
+        SplitJournal journal(path);
+        restart(&journal, n, 1, &replayed);
+        runJob(&journal, replayed, 80, &expected);
+        journal.sync();
+        journal.compact(40, doneFrom(expected, 40));
+    }
+    {
+        SplitJournal journal(path);
+        check(!restart(&journal, n, 2, &replayed), "other split names are refused");
+    }
+    {
+        // a name changes below the watermark, where only the failed splits have records
+        SplitJournal journal(path);
+        bool matched = journal.open();
+        Status::value status;
+        for(uint64_t i = 0; matched && (i < 40); i++) {
+            matched = journal.replayedStatus(i, splitName((i == 20) ? 21 : i, 1), &status);
+        }
+        check(!matched, "a changed name below the watermark is refused");
+    }
+    {
+        // and above it, where every split that is done has a record
+        SplitJournal journal(path);
+        bool matched = journal.open();
+        Status::value status;
+        for(uint64_t i = 0; matched && (i < n); i++) {
+            matched = journal.replayedStatus(i, splitName((i == 50) ? 51 : i, 1), &status);
+        }
+        check(!matched, "a changed name above the watermark is refused");
+    }
+    SplitJournal journal(path);
+    check(restart(&journal, n, 1, &replayed) && (replayed == expected), "the same splits still replay");
+}
+
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// a dispatch and an answer per split, synced in batches like the master's journal timer
+static void timeAppends(const std::string& dir) {
+    const std::string path = dir + "/time";
+    const uint64_t n = 200000;
+    const uint64_t perSync[] = {100, 1000, 10000};
+    for(size_t j = 0; j < sizeof(perSync) / sizeof(perSync[0]); j++) {
+        unlink(path.c_str());
+        SplitJournal journal(path);
+        Statuses replayed;
+        restart(&journal, n, 1, &replayed);
+        double appendSeconds = 0;
+        double syncSeconds = 0;
+        for(uint64_t i = 0; i < n; i += perSync[j]) {
+            double start = nowSeconds();
+            for(uint64_t k = i; (k < i + perSync[j]) && (k < n); k++) {
+                journal.append(k, JournalRecordType::DISPATCHED);
+                journal.append(k, JournalRecordType::OK);
+            }
+            double synced = nowSeconds();
+            journal.sync();
+            appendSeconds += synced - start;
+            syncSeconds += nowSeconds() - synced;
+        }
+        printf("%6d splits per sync: %6.1f ns per split to append, %8.1f us per sync, %.2f us per split in total\n",
+               static_cast<int>(perSync[j]), appendSeconds * 1e9 / n, syncSeconds * 1e6 / (n / perSync[j]),
+               (appendSeconds + syncSeconds) * 1e6 / n);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string dir = (boost::format("%s/journal_check.XXXXXX") % ((argc > 1) ? argv[1] : "/tmp")).str();
+    if(mkdtemp(&dir[0]) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    checkReplay(dir);
+    checkTornTail(dir);
+    checkCompaction(dir);
+    checkMismatch(dir);
+    timeAppends(dir);
+
+    if(system(("rm -rf " + dir).c_str()) != 0) {
+        printf("can't remove %s\n", dir.c_str());
+    }
+    printf("%d checks failed\n", numFailures);
+    return (numFailures == 0) ? 0 : 1;
+}
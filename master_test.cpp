@@ -1,3 +1,5 @@
+#include <stdlib.h>
+#include <string.h>
 #include <map>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
@@ -10,29 +12,67 @@
 #include "distributor/distributor.pb.h"
 #include "distributor/master.h"
 #include "distributor/split.h"
+#include "distributor/splitsource.h"
 #include "distributor/transport.h"
 
 int main(int argc, char*argv[]) {
     google::InitGoogleLogging(argv[0]);
     using namespace ddc::distributor;
     base::ProducerConsumerQueue<base::Block<FullRequest> > requestQueue;
+    base::ProducerConsumerQueue<base::Block<FullRequest> > controlQueue;
     base::ProducerConsumerQueue<base::Block<FullRequest> > responseQueue;
-    // allow N requests and responses in flight
-    // Set queue size keeping in mind the processing time of the worker and the hearbeat timeout.
-    // Otherwise we can queue up a lot of stuff for one worker and if another worker joins,
-    // the heartbeat will time out. Increase hearbeat timeout for bigger queue sizes.
+    // messages waiting between the master and the transport. How many splits each worker has
+    // in flight is up to the credits it advertises, not these queues.
+    // This is just the starting size. The master resizes both queues as workers register
+    // and after how fast the workers get through splits, see Master::resizeQueues()
     requestQueue.configure(5);
     responseQueue.configure(5);
-    uint64_t numRequests = 1;
-    if(argc == 2) {
-        numRequests = atoi(argv[1]);
-        assert(numRequests < 1000000);
+    // heartbeats and shutdowns. Transport always sends these first
+    controlQueue.configure(64);
+    // cheap enough to leave on. Master logs them periodically
+    requestQueue.enableStats(true);
+    responseQueue.enableStats(true);
+    controlQueue.enableStats(true);
+    // master_test [N | -m manifest | -d directory] [-j journal]
+    // N unnamed splits, a split per line of manifest or a split per file under directory.
+    // With a journal, running the same command again after a crash skips the splits that are done
+    SplitSource* splits = NULL;
+    const char* journal = NULL;
+    for(int i = 1; i < argc; i++) {
+        if((strcmp(argv[i], "-m") == 0) && (i + 1 < argc)) {
+            splits = new ManifestSplitSource(argv[++i]);
+        }
+        else if((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) {
+            splits = new DirectorySplitSource(argv[++i]);
+        }
+        else if((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+            journal = argv[++i];
+        }
+        else {
+            splits = new GeneratorSplitSource(strtoull(argv[i], NULL, 10));
+        }
     }
-    Master m(&requestQueue, &responseQueue, numRequests);
-    Transport t(&requestQueue, &responseQueue);
+    if(splits == NULL) {
+        splits = new GeneratorSplitSource(1);
+    }
+    Master m(&requestQueue, &controlQueue, &responseQueue, splits);
+    if(journal != NULL) {
+        m.setJournal(journal);
+    }
+    Transport t(&requestQueue, &controlQueue, &responseQueue);
+
+    // Master and Transport sleep in poll() but wake up for every batch of messages and hand
+    // them to each other through the queues. Give each its own core so a wakeup doesn't wait
+    // for a core or land on a cold cache, ideally cores kept free with isolcpus=1,2
+    base::ThreadOptions masterOptions;
+    masterOptions.name = "master";
+    masterOptions.cpus.push_back(1);
+    base::ThreadOptions transportOptions;
+    transportOptions.name = "transport";
+    transportOptions.cpus.push_back(2);
 
-    m.start();
-    t.start();
+    m.start(masterOptions);
+    t.start(transportOptions);
 
     //wait until master is done
     m.join();
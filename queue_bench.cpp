@@ -0,0 +1,523 @@
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <boost/thread.hpp>
+
+#include "base/mpmcqueue.h"
+#include "base/producerconsumerqueue.h"
+#include "base/spscqueue.h"
+#include "distributor/split.h"
+
+/**
+ * Benchmarks for the queues between pipeline stages.
+ *
+ * $ ./queue_bench                       # human readable
+ * $ make bench                          # also writes queue_bench.json to compare runs
+ * $ ./queue_bench --benchmark_filter=Split   # only the split tracking tables of the master
+ */
+
+using ddc::distributor::FullRequest;
+using ddc::distributor::SplitAttempt;
+using ddc::distributor::SplitId;
+using ddc::distributor::SplitTrackingInfo;
+using ddc::distributor::WorkerId;
+
+typedef base::ProducerConsumerQueue<base::Block<uint64_t> > IntQueue;
+typedef base::SpscQueue<base::Block<uint64_t> > IntSpscQueue;
+typedef base::MpmcQueue<base::Block<uint64_t> > IntMpmcQueue;
+typedef base::ProducerConsumerQueue<base::Block<FullRequest> > RequestQueue;
+typedef base::SpscQueue<base::Block<FullRequest> > RequestSpscQueue;
+
+/**
+ * Payloads. fill() writes item i into the data of a block, the way a producer would.
+ */
+struct IntPayload {
+    typedef uint64_t Data;
+    static void fill(uint64_t& data, uint64_t i) {
+        data = i;
+    }
+};
+
+// split request like the ones the master sends
+struct SmallRequestPayload {
+    typedef FullRequest Data;
+    static void fill(FullRequest& data, uint64_t i) {
+        data.emplace(ddc::distributor::AnyRequest_Type_FETCH_SPLIT_REQUEST, "ip-1234")
+            .mutable_fetchsplitrequest()->set_id(i);
+    }
+};
+
+// split request carrying 64KB
+struct LargeRequestPayload {
+    typedef FullRequest Data;
+    static void fill(FullRequest& data, uint64_t i) {
+        static const std::string payload(64 * 1024, 'x');
+        ddc::distributor::FetchSplitRequest* request =
+            data.emplace(ddc::distributor::AnyRequest_Type_FETCH_SPLIT_REQUEST, "ip-1234").mutable_fetchsplitrequest();
+        request->set_id(i);
+        request->set_filename(payload);
+    }
+};
+
+template <typename Queue>
+static void configureQueue(Queue& queue, uint32_t capacity, base::WaitPolicy::value policy) {
+    queue.configure(capacity, policy);
+}
+
+// SpscQueue never waits, there is no policy to set
+template <typename T>
+static void configureQueue(base::SpscQueue<T>& queue, uint32_t capacity, base::WaitPolicy::value policy) {
+    queue.configure(capacity);
+}
+
+// pin the calling thread. Wraps around if the machine has less cpus
+static void pinToCpu(int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu % boost::thread::hardware_concurrency(), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+static double processCpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double wallSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Single threaded cost of one write + one read on a queue of the given capacity, with or without stats.
+ * The queue is kept half full so the blocks handed out are spread all over it.
+ */
+static void BM_WriteRead(benchmark::State& state) {
+    const uint32_t capacity = state.range(0);
+    IntQueue queue;
+    queue.configure(capacity);
+    queue.enableStats(state.range(1));
+
+    base::Block<uint64_t> *block;
+    for(uint32_t i = 0; i < capacity / 2; i++) {
+        queue.tryGetWriteSlot(&block);
+        block->data = i;
+        queue.slotWritten(block);
+    }
+
+    uint64_t i = 0;
+    for (auto _ : state) {
+        queue.tryGetWriteSlot(&block);
+        block->data = i++;
+        queue.slotWritten(block);
+
+        queue.tryGetReadSlot(&block);
+        benchmark::DoNotOptimize(block->data);
+        queue.slotRead(block);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteRead)->ArgNames({"capacity", "stats"})
+    ->ArgsProduct({{5, 8, 64, 512, 4096, 32768, 65536}, {0}})
+    ->ArgsProduct({{5, 65536}, {1}});
+
+/**
+ * Same as BM_WriteRead for SpscQueue. The queue is kept half full too.
+ */
+static void BM_WriteReadSpsc(benchmark::State& state) {
+    const uint32_t capacity = state.range(0);
+    IntSpscQueue queue;
+    queue.configure(capacity);
+
+    base::Block<uint64_t> *block;
+    for(uint32_t i = 0; i < capacity / 2; i++) {
+        queue.tryGetWriteSlot(&block);
+        block->data = i;
+        queue.slotWritten(block);
+    }
+
+    uint64_t i = 0;
+    for (auto _ : state) {
+        queue.tryGetWriteSlot(&block);
+        block->data = i++;
+        queue.slotWritten(block);
+
+        queue.tryGetReadSlot(&block);
+        benchmark::DoNotOptimize(block->data);
+        queue.slotRead(block);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteReadSpsc)->ArgName("capacity")->Arg(5)->Arg(64)->Arg(4096)->Arg(65536);
+
+/**
+ * Same as BM_WriteRead for MpmcQueue, from a single thread.
+ */
+static void BM_WriteReadMpmc(benchmark::State& state) {
+    const uint32_t capacity = state.range(0);
+    IntMpmcQueue queue;
+    queue.configure(capacity);
+
+    base::Block<uint64_t> *block;
+    for(uint32_t i = 0; i < capacity / 2; i++) {
+        queue.tryGetWriteSlot(&block);
+        block->data = i;
+        queue.slotWritten(block);
+    }
+
+    uint64_t i = 0;
+    for (auto _ : state) {
+        queue.tryGetWriteSlot(&block);
+        block->data = i++;
+        queue.slotWritten(block);
+
+        queue.tryGetReadSlot(&block);
+        benchmark::DoNotOptimize(block->data);
+        queue.slotRead(block);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteReadMpmc)->ArgName("capacity")->Arg(8)->Arg(64)->Arg(4096)->Arg(65536);
+
+/**
+ * Same as BM_WriteRead but moving range(1) blocks per lock with the batch API.
+ */
+static void BM_WriteReadBatch(benchmark::State& state) {
+    const uint32_t capacity = state.range(0);
+    const uint32_t batch = state.range(1);
+    IntQueue queue;
+    queue.configure(capacity);
+
+    std::vector<base::Block<uint64_t> *> blocks;
+    uint64_t i = 0;
+    for (auto _ : state) {
+        queue.tryGetWriteSlots(blocks, batch);
+        for(size_t j = 0; j < blocks.size(); j++) {
+            blocks[j]->data = i++;
+        }
+        queue.slotsWritten(blocks);
+
+        queue.tryGetReadSlots(blocks, batch);
+        for(size_t j = 0; j < blocks.size(); j++) {
+            benchmark::DoNotOptimize(blocks[j]->data);
+        }
+        queue.slotsRead(blocks);
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_WriteReadBatch)->ArgNames({"capacity", "batch"})
+    ->Args({1024, 1})->Args({1024, 16})->Args({1024, 64})->Args({1024, 256});
+
+/**
+ * Round trip of one block between two threads pinned to cpus 0 and 1, through a pair of
+ * queues using the wait policy in range(0) (ignored by SpscQueue).
+ * cpu_per_wall is the cpu time of the whole process over wall time: about 2 means both
+ * threads burnt a core each while waiting.
+ */
+template <typename Queue>
+static void BM_PingPong(benchmark::State& state) {
+    const base::WaitPolicy::value policy = static_cast<base::WaitPolicy::value>(state.range(0));
+    Queue ping;
+    Queue pong;
+    configureQueue(ping, 8, policy);
+    configureQueue(pong, 8, policy);
+
+    boost::thread echo([&ping, &pong]() {
+        pinToCpu(1);
+        base::Block<uint64_t> *in;
+        base::Block<uint64_t> *out;
+        while(true) {
+            while(!ping.tryGetReadSlot(&in)) {
+            }
+            uint64_t value = in->data;
+            ping.slotRead(in);
+            while(!pong.tryGetWriteSlot(&out)) {
+            }
+            out->data = value;
+            pong.slotWritten(out);
+            if(value == UINT64_MAX) {
+                return;
+            }
+        }
+    });
+    pinToCpu(0);
+
+    base::Block<uint64_t> *block;
+    uint64_t i = 0;
+    double cpuStart = processCpuSeconds();
+    double wallStart = wallSeconds();
+    for (auto _ : state) {
+        while(!ping.tryGetWriteSlot(&block)) {
+        }
+        block->data = i++;
+        ping.slotWritten(block);
+        while(!pong.tryGetReadSlot(&block)) {
+        }
+        pong.slotRead(block);
+    }
+    state.counters["cpu_per_wall"] = (processCpuSeconds() - cpuStart) / (wallSeconds() - wallStart);
+
+    while(!ping.tryGetWriteSlot(&block)) {
+    }
+    block->data = UINT64_MAX;
+    ping.slotWritten(block);
+    echo.join();
+}
+BENCHMARK_TEMPLATE(BM_PingPong, IntQueue)->ArgName("policy")
+    ->Arg(base::WaitPolicy::PARK)->Arg(base::WaitPolicy::SPIN)->Arg(base::WaitPolicy::ADAPTIVE)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PingPong, IntSpscQueue)->ArgName("policy")->Arg(base::WaitPolicy::SPIN)->UseRealTime();
+
+/**
+ * Sustained throughput: the benchmark thread (pinned to cpu 0) fills Payload blocks as
+ * fast as it can and a consumer pinned to cpu 1 drains them.
+ * range(0) is the capacity.
+ */
+template <typename Queue, typename Payload>
+static void BM_Throughput(benchmark::State& state) {
+    Queue queue;
+    configureQueue(queue, state.range(0), base::WaitPolicy::ADAPTIVE);
+
+    boost::thread consumer([&queue]() {
+        pinToCpu(1);
+        base::Block<typename Payload::Data> *block;
+        while(true) {
+            while(!queue.tryGetReadSlot(&block)) {
+            }
+            bool last = block->shutdownStage;
+            benchmark::DoNotOptimize(block->data);
+            queue.slotRead(block);
+            if(last) {
+                return;
+            }
+        }
+    });
+    pinToCpu(0);
+
+    base::Block<typename Payload::Data> *block;
+    uint64_t i = 0;
+    for (auto _ : state) {
+        while(!queue.tryGetWriteSlot(&block)) {
+        }
+        Payload::fill(block->data, i++);
+        block->shutdownStage = false;
+        queue.slotWritten(block);
+    }
+
+    while(!queue.tryGetWriteSlot(&block)) {
+    }
+    block->shutdownStage = true;
+    queue.slotWritten(block);
+    consumer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+#define THROUGHPUT_BENCHMARK(Queue, Payload) \
+    BENCHMARK_TEMPLATE(BM_Throughput, Queue, Payload)->ArgName("capacity") \
+        ->Arg(8)->Arg(64)->Arg(1024)->UseRealTime()
+THROUGHPUT_BENCHMARK(IntQueue, IntPayload);
+THROUGHPUT_BENCHMARK(IntSpscQueue, IntPayload);
+THROUGHPUT_BENCHMARK(RequestQueue, SmallRequestPayload);
+THROUGHPUT_BENCHMARK(RequestSpscQueue, SmallRequestPayload);
+THROUGHPUT_BENCHMARK(RequestQueue, LargeRequestPayload);
+THROUGHPUT_BENCHMARK(RequestSpscQueue, LargeRequestPayload);
+
+/**
+ * Fan-in/fan-out through a MpmcQueue of 1024 blocks: range(0) producers push
+ * kItemsPerRun values between them and range(1) consumers pop them.
+ * Doubles as a stress test, every run checks that each value came out exactly once.
+ */
+static const uint64_t kItemsPerRun = 200000;
+
+static void BM_MpmcFanInOut(benchmark::State& state) {
+    const int producers = state.range(0);
+    const int consumers = state.range(1);
+    IntMpmcQueue queue;
+    queue.configure(1024);
+
+    for (auto _ : state) {
+        boost::atomic<uint64_t> sum(0);
+        boost::atomic<uint64_t> count(0);
+        boost::thread_group threads;
+        for(int p = 0; p < producers; p++) {
+            threads.create_thread([&queue, p, producers]() {
+                base::Block<uint64_t> *block;
+                for(uint64_t i = p; i < kItemsPerRun; i += producers) {
+                    queue.getWriteSlot(&block);
+                    block->data = i;
+                    queue.slotWritten(block);
+                }
+            });
+        }
+        for(int c = 0; c < consumers; c++) {
+            threads.create_thread([&queue, &sum, &count]() {
+                base::Block<uint64_t> *block;
+                uint64_t localSum = 0;
+                uint64_t localCount = 0;
+                while(count.load() < kItemsPerRun) {
+                    if(!queue.tryGetReadSlot(&block)) {
+                        boost::this_thread::yield();
+                        continue;
+                    }
+                    localSum += block->data;
+                    localCount++;
+                    queue.slotRead(block);
+                    count.fetch_add(1);
+                }
+                sum.fetch_add(localSum);
+            });
+        }
+        threads.join_all();
+
+        if(count.load() != kItemsPerRun || sum.load() != kItemsPerRun * (kItemsPerRun - 1) / 2) {
+            state.SkipWithError("MpmcQueue lost or duplicated items");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kItemsPerRun);
+}
+BENCHMARK(BM_MpmcFanInOut)->ArgNames({"producers", "consumers"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {1, 2, 4, 8, 16}})
+    ->UseRealTime();
+
+/**
+ * Split tracking. The master used to keep splits in a std::map keyed by their name ("split%d"),
+ * now it keeps a window of them in a deque indexed by their dense id.
+ * The map here holds today's SplitTrackingInfo, smaller than the one it held then
+ * (that one had copies of worker names), so its memory is a lower bound.
+ */
+static const uint64_t kNumTrackedSplits = 1000000;
+
+// bytes in use on the heap
+static uint64_t heapBytes() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    return mallinfo2().uordblks;
+#else
+    return static_cast<unsigned int>(mallinfo().uordblks);
+#endif
+}
+
+// sent once, like a job without retries
+static SplitTrackingInfo trackedSplit(SplitId id) {
+    SplitTrackingInfo split;
+    split.id = id;
+    split.worker = id % 16;
+    split.copiesInFlight = 1;
+    split.firstAttempt = SplitAttempt(split.worker, id);
+    return split;
+}
+
+struct SplitsByName {
+    typedef std::map<std::string, SplitTrackingInfo> Table;
+    typedef std::string Key;
+    static Key key(SplitId id) {
+        char name[32];
+        snprintf(name, sizeof(name), "split%llu", static_cast<unsigned long long>(id));
+        return name;
+    }
+    static void add(Table& table, SplitId id) {
+        table[key(id)] = trackedSplit(id);
+    }
+    static SplitTrackingInfo* find(Table& table, const Key& key) {
+        Table::iterator it = table.find(key);
+        return (it == table.end()) ? NULL : &it->second;
+    }
+};
+
+// the window of Master::splits_, starting at split 0
+struct SplitsById {
+    typedef std::deque<SplitTrackingInfo> Table;
+    typedef SplitId Key;
+    static Key key(SplitId id) {
+        return id;
+    }
+    static void add(Table& table, SplitId id) {
+        table.push_back(trackedSplit(id));
+    }
+    static SplitTrackingInfo* find(Table& table, Key key) {
+        return (key < table.size()) ? &table[key] : NULL;
+    }
+};
+
+/**
+ * Looking up the split of a response. Responses come back in random order, workers don't run at the same speed
+ */
+template <typename Splits>
+static void BM_SplitLookup(benchmark::State& state) {
+    typename Splits::Table table;
+    std::vector<typename Splits::Key> keys;
+    for(SplitId id = 0; id < kNumTrackedSplits; id++) {
+        Splits::add(table, id);
+        keys.push_back(Splits::key(id));
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Splits::find(table, keys[i]));
+        if(++i == keys.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SplitLookup, SplitsByName);
+BENCHMARK_TEMPLATE(BM_SplitLookup, SplitsById);
+
+/**
+ * The worker handle of a response, looked up by name among 16 workers
+ */
+static void BM_WorkerIdLookup(benchmark::State& state) {
+    std::map<std::string, WorkerId> ids;
+    std::vector<std::string> names;
+    for(WorkerId id = 0; id < 16; id++) {
+        names.push_back("ip-" + std::to_string(1234 + id));
+        ids[names.back()] = id;
+    }
+    std::vector<std::string> responses;
+    std::mt19937 random(42);
+    for(int i = 0; i < 4096; i++) {
+        responses.push_back(names[random() % names.size()]);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ids.find(responses[i]));
+        i = (i + 1) % responses.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WorkerIdLookup);
+
+/**
+ * Building the table for kNumTrackedSplits splits. heap_per_split is what the table allocates per split,
+ * entry_bytes is sizeof(SplitTrackingInfo)
+ */
+template <typename Splits>
+static void BM_SplitTableMemory(benchmark::State& state) {
+    for (auto _ : state) {
+        uint64_t before = heapBytes();
+        typename Splits::Table table;
+        for(SplitId id = 0; id < kNumTrackedSplits; id++) {
+            Splits::add(table, id);
+        }
+        state.counters["heap_per_split"] = static_cast<double>(heapBytes() - before) / kNumTrackedSplits;
+    }
+    state.counters["entry_bytes"] = sizeof(SplitTrackingInfo);
+    state.SetItemsProcessed(state.iterations() * kNumTrackedSplits);
+}
+BENCHMARK_TEMPLATE(BM_SplitTableMemory, SplitsByName)->Unit(benchmark::kMillisecond)->Iterations(3);
+BENCHMARK_TEMPLATE(BM_SplitTableMemory, SplitsById)->Unit(benchmark::kMillisecond)->Iterations(3);
+
+BENCHMARK_MAIN();
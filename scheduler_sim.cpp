@@ -0,0 +1,129 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "distributor/scheduler.h"
+
+/**
+ * Simulates sending splits to workers of different speeds with every scheduler policy
+ * and prints the makespan (time until the last split is done).
+ *
+ * Every split takes between 0.5 and 1.5 units of work. A worker does speed units of work per
+ * second and works through its splits in order. At most kInFlightPerWorker x workers splits are
+ * outstanding at any time, either in total like a bounded request queue, or per worker like
+ * the credits workers advertise to the master.
+ *
+ * $ make scheduler_sim && ./scheduler_sim
+ */
+
+using namespace ddc::distributor;
+
+static const int kNumWorkers = 16;
+static const int kNumSplits = 20000;
+static const int kInFlightPerWorker = 4;
+
+struct Scenario {
+    const char* name;
+    std::vector<double> speeds;
+};
+
+// {time the split is done, worker}, earliest first
+typedef std::pair<double, int> Completion;
+typedef std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion> > Completions;
+
+static double simulate(SchedulerPolicy::value policy, const Scenario& scenario, const std::vector<double>& work,
+                       bool credits) {
+    Scheduler* scheduler = Scheduler::create(policy);
+    std::vector<std::string> names;
+    std::map<std::string, int> index;
+    std::vector<double> busyUntil(scenario.speeds.size(), 0);
+    for(int i = 0; i < scenario.speeds.size(); i++) {
+        names.push_back((boost::format("worker%d") % i).str());
+        index[names.back()] = i;
+        scheduler->addWorker(names.back(), credits ? kInFlightPerWorker : Scheduler::kUnlimitedCredits);
+    }
+
+    Completions completions;
+    size_t next = 0;
+    double now = 0;
+    const size_t maxInFlight = kInFlightPerWorker * scenario.speeds.size();
+    while((next < work.size()) || !completions.empty()) {
+        // send while there is room
+        while((next < work.size()) && (completions.size() < maxInFlight) && (scheduler->numAvailableWorkers() > 0)) {
+            const std::string& chosen = scheduler->chooseWorker();
+            int worker = index[chosen];
+            busyUntil[worker] = std::max(busyUntil[worker], now) + work[next++] / scenario.speeds[worker];
+            completions.push(Completion(busyUntil[worker], worker));
+            scheduler->onSplitSent(chosen);
+        }
+        // next response
+        Completion done = completions.top();
+        completions.pop();
+        now = done.first;
+        scheduler->onSplitDone(names[done.second]);
+    }
+    delete scheduler;
+    return now;
+}
+
+int main(int argc, char* argv[]) {
+    boost::random::mt19937 random(42);
+    boost::random::uniform_real_distribution<double> splitWork(0.5, 1.5);
+    std::vector<double> work;
+    double totalWork = 0;
+    for(int i = 0; i < kNumSplits; i++) {
+        work.push_back(splitWork(random));
+        totalWork += work.back();
+    }
+
+    std::vector<Scenario> scenarios;
+    Scenario uniform = { "all the same speed", std::vector<double>(kNumWorkers, 1.0) };
+    scenarios.push_back(uniform);
+    Scenario fastQuarter = { "a quarter 4x faster", std::vector<double>(kNumWorkers, 1.0) };
+    for(int i = 0; i < kNumWorkers / 4; i++) {
+        fastQuarter.speeds[i] = 4.0;
+    }
+    scenarios.push_back(fastQuarter);
+    Scenario straggler = { "one 10x slower", std::vector<double>(kNumWorkers, 1.0) };
+    straggler.speeds[0] = 0.1;
+    scenarios.push_back(straggler);
+    Scenario spread = { "speeds 0.25x to 4x", std::vector<double>(kNumWorkers, 1.0) };
+    boost::random::uniform_real_distribution<double> exponent(-2, 2);
+    for(int i = 0; i < kNumWorkers; i++) {
+        spread.speeds[i] = pow(2, exponent(random));
+    }
+    scenarios.push_back(spread);
+
+    const SchedulerPolicy::value policies[] = { SchedulerPolicy::ROUND_ROBIN,
+                                                SchedulerPolicy::LEAST_OUTSTANDING,
+                                                SchedulerPolicy::POWER_OF_TWO_CHOICES };
+    const char* policyNames[] = { "round robin", "least outstanding", "power of two" };
+
+    for(int credits = 0; credits < 2; credits++) {
+        printf("%d splits, %d workers, %d splits in flight per worker %s\n", kNumSplits, kNumWorkers, kInFlightPerWorker,
+               credits ? "(credits, per worker)" : "(in total)");
+        printf("%-22s %12s %12s %18s %14s\n", "scenario", "ideal", policyNames[0], policyNames[1], policyNames[2]);
+        for(int s = 0; s < scenarios.size(); s++) {
+            double totalSpeed = 0;
+            for(int i = 0; i < scenarios[s].speeds.size(); i++) {
+                totalSpeed += scenarios[s].speeds[i];
+            }
+            printf("%-22s %12.1f", scenarios[s].name, totalWork / totalSpeed);
+            for(int p = 0; p < 3; p++) {
+                printf(" %*.1f", p == 1 ? 18 : (p == 0 ? 12 : 14), simulate(policies[p], scenarios[s], work, credits));
+            }
+            printf("\n");
+        }
+        printf("\n");
+    }
+    return 0;
+}